@@ -8,6 +8,11 @@
 #include <vector>
 #include <cassert>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <exception>
 
 #include "csv_row.h"
 #include "file_parser.h"
@@ -18,6 +23,18 @@
 #include "hashing.h"
 #include "file_iterator.h"
 #include "exit_signal.h"
+#include "game.h"
+#include "sumgame.h"
+#include "test_work_queue.h"
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__EMSCRIPTEN__)
+#define AUTOTESTS_PARALLEL_SUPPORTED
+#include <cerrno>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 //////////////////////////////////////////////////
 using namespace std;
@@ -26,13 +43,22 @@ using namespace std;
 inline constexpr const char NEWLINE = '\n';
 
 
+//////////////////////////////////////// helper functions
+namespace {
+void run_autotests_parallel(const string& root_test_directory,
+                            ofstream& outfile,
+                            unsigned long long test_timeout,
+                            test_filter_enum filter_type, size_t n_jobs);
+} // namespace
+
 //////////////////////////////////////// exported functions
 void run_autotests(const string& root_test_directory,
                    const string& outfile_name, unsigned long long test_timeout,
-                   test_filter_enum filter_type)
+                   test_filter_enum filter_type, size_t n_jobs)
 {
     CHECK_EXIT_SIGNAL_0();
     THROW_ASSERT(root_test_directory.size() > 0);
+    THROW_ASSERT(n_jobs > 0);
 
     uint64_t n_tests_filtered = 0;
 
@@ -50,6 +76,14 @@ void run_autotests(const string& root_test_directory,
     vector<string> header_fields = csv_row::get_header_field_strings();
     write_csv_field_strings(outfile, header_fields);
 
+    if (n_jobs > 1)
+    {
+        run_autotests_parallel(root_test_directory, outfile, test_timeout,
+                               filter_type, n_jobs);
+        outfile.close();
+        return;
+    }
+
     // iterate over all files in root test directory
     for (file_iterator_alphabetical iter(root_test_directory); iter; ++iter)
     {
@@ -122,3 +156,400 @@ void run_autotests(const string& root_test_directory,
 
     outfile.close();
 }
+
+//////////////////////////////////////// parallel autotests
+namespace {
+struct pending_test
+{
+    shared_ptr<i_test_case> test_case;
+    string file_name;
+    int file_test_idx;
+};
+
+/*
+    Read and filter all test cases in the order of the serial loop, filling
+    their autotest fields. Returns the number of filtered tests
+*/
+uint64_t collect_tests(const string& root_test_directory,
+                       test_filter_enum filter_type,
+                       vector<pending_test>& tests)
+{
+    uint64_t n_tests_filtered = 0;
+
+    for (file_iterator_alphabetical iter(root_test_directory); iter; ++iter)
+    {
+        CHECK_EXIT_SIGNAL_1(return n_tests_filtered;);
+
+        const filesystem::directory_entry& entry = iter.gen_entry();
+        assert(!entry.is_directory());
+
+        if (!entry.is_regular_file())
+            continue;
+
+        const filesystem::path& file_path = entry.path();
+
+        if (file_path.extension() != ".test")
+            continue;
+
+        const string file_name = file_path.string();
+
+        cout << "New file: " << file_name << endl;
+
+        filesystem::path relative_file_path = filesystem::relative(
+            file_path, filesystem::path(root_test_directory));
+
+        unique_ptr<file_parser> parser =
+            unique_ptr<file_parser>(file_parser::from_file(file_name));
+
+        int file_test_idx = 0;
+
+        while (parser->parse_chunk())
+        {
+            const int n_chunk_tests = parser->n_test_cases();
+            for (int chunk_test_idx = 0; chunk_test_idx < n_chunk_tests;
+                 chunk_test_idx++)
+            {
+                shared_ptr<i_test_case> test_case =
+                    parser->get_test_case(chunk_test_idx);
+
+                if (!test_filter_permits_test_case(filter_type, *test_case))
+                {
+                    n_tests_filtered++;
+                    continue;
+                }
+
+                test_case->get_csv_row().fill_autotest_fields(
+                    relative_file_path.string(), file_test_idx);
+
+                tests.push_back({test_case, file_name, file_test_idx});
+                file_test_idx++;
+            }
+        }
+    }
+
+    return n_tests_filtered;
+}
+
+// Total number of moves of both players in all games of the test case
+uint64_t predict_difficulty(const i_test_case& test_case)
+{
+    uint64_t n_moves = 0;
+
+    for (const game* g : test_case.get_games())
+    {
+        for (bw player : {BLACK, WHITE})
+        {
+            unique_ptr<move_generator> gen(g->create_move_generator(player));
+
+            for (; *gen; ++(*gen))
+                n_moves++;
+        }
+    }
+
+    return n_moves;
+}
+
+#ifndef AUTOTESTS_PARALLEL_SUPPORTED
+void run_autotests_parallel(const string& root_test_directory,
+                            ofstream& outfile,
+                            unsigned long long test_timeout,
+                            test_filter_enum filter_type, size_t n_jobs)
+{
+    THROW_ASSERT(false, "--test-jobs isn't supported on this platform");
+}
+
+#else
+/*
+    Row message from a worker to the parent:
+        uint64_t test index
+        uint32_t number of fields
+        for each field: uint32_t length, then the field's characters
+*/
+void append_bytes(string& message, const void* data, size_t size)
+{
+    message.append(static_cast<const char*>(data), size);
+}
+
+string encode_row(uint64_t test_idx, const vector<string>& fields)
+{
+    string message;
+
+    append_bytes(message, &test_idx, sizeof(test_idx));
+
+    const uint32_t n_fields = fields.size();
+    append_bytes(message, &n_fields, sizeof(n_fields));
+
+    for (const string& field : fields)
+    {
+        const uint32_t length = field.size();
+        append_bytes(message, &length, sizeof(length));
+        message.append(field);
+    }
+
+    return message;
+}
+
+template <class T>
+bool read_value(const string& buffer, size_t& pos, T& value)
+{
+    if (buffer.size() - pos < sizeof(T))
+        return false;
+
+    memcpy(&value, buffer.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+/*
+    Decode one message from the front of buffer, and erase it. Returns false
+    if buffer doesn't yet hold a full message
+*/
+bool decode_row(string& buffer, uint64_t& test_idx, vector<string>& fields)
+{
+    size_t pos = 0;
+    uint32_t n_fields;
+
+    if (!read_value(buffer, pos, test_idx) ||
+        !read_value(buffer, pos, n_fields))
+        return false;
+
+    vector<string> decoded;
+    decoded.reserve(n_fields);
+
+    for (uint32_t i = 0; i < n_fields; i++)
+    {
+        uint32_t length;
+
+        if (!read_value(buffer, pos, length) || buffer.size() - pos < length)
+            return false;
+
+        decoded.emplace_back(buffer, pos, length);
+        pos += length;
+    }
+
+    buffer.erase(0, pos);
+    fields = std::move(decoded);
+    return true;
+}
+
+void write_all(int fd, const string& message)
+{
+    size_t pos = 0;
+
+    while (pos < message.size())
+    {
+        const ssize_t n_written =
+            write(fd, message.data() + pos, message.size() - pos);
+
+        if (n_written < 0 && errno == EINTR)
+            continue;
+
+        THROW_ASSERT(n_written > 0, "Failed to write to test result pipe");
+        pos += n_written;
+    }
+}
+
+// Runs in a forked worker process. Never returns
+[[noreturn]] void run_worker(vector<pending_test>& tests,
+                             const vector<size_t>& schedule,
+                             test_work_queue& queue, size_t worker_idx,
+                             int write_fd, unsigned long long test_timeout)
+{
+    int exit_code = 0;
+
+    try
+    {
+        while (!exit_signal::mcgs_should_stop())
+        {
+            optional<size_t> position = queue.pop(worker_idx);
+
+            if (!position.has_value())
+                break;
+
+            const size_t test_idx = schedule[*position];
+            i_test_case& test_case = *tests[test_idx].test_case;
+
+            test_case.run(test_timeout);
+
+            const vector<string> row_fields =
+                test_case.get_csv_row().get_row_field_strings();
+            write_all(write_fd, encode_row(test_idx, row_fields));
+        }
+    }
+    catch (const exception& exc)
+    {
+        cerr << "Test worker " << worker_idx << " failed: " << exc.what()
+             << endl;
+        exit_code = 1;
+    }
+
+    close(write_fd);
+
+    // Skip destructors and atexit handlers, which belong to the parent
+    cout.flush();
+    _exit(exit_code);
+}
+
+void run_autotests_parallel(const string& root_test_directory,
+                            ofstream& outfile,
+                            unsigned long long test_timeout,
+                            test_filter_enum filter_type, size_t n_jobs)
+{
+    vector<pending_test> tests;
+    const uint64_t n_tests_filtered =
+        collect_tests(root_test_directory, filter_type, tests);
+
+    CHECK_EXIT_SIGNAL_0();
+
+    if (n_tests_filtered > 0)
+        cout << n_tests_filtered << " skipped by the test filter" << endl;
+
+    const size_t n_tests = tests.size();
+    n_jobs = min(n_jobs, max<size_t>(n_tests, 1));
+
+    vector<uint64_t> difficulties;
+    difficulties.reserve(n_tests);
+
+    for (const pending_test& test : tests)
+        difficulties.push_back(predict_difficulty(*test.test_case));
+
+    const vector<size_t> schedule = make_test_schedule(difficulties, n_jobs);
+
+    // Each test starts from empty ttables, whichever worker runs it
+    global::clear_tt.set(true);
+
+    // Queue ranges are shared by all workers
+    const size_t ranges_size = test_work_queue::ranges_size(n_jobs);
+    void* ranges = mmap(nullptr, ranges_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    THROW_ASSERT(ranges != MAP_FAILED, "Failed to map test work queue");
+
+    test_work_queue queue(ranges, n_jobs, n_tests);
+
+    vector<pid_t> pids;
+    vector<int> read_fds;
+
+    cout.flush();
+    cerr.flush();
+    outfile.flush();
+
+    for (size_t worker_idx = 0; worker_idx < n_jobs; worker_idx++)
+    {
+        int fds[2];
+        THROW_ASSERT(pipe(fds) == 0, "Failed to create test result pipe");
+
+        const pid_t pid = fork();
+        THROW_ASSERT(pid != -1, "Failed to fork test worker");
+
+        if (pid == 0)
+        {
+            close(fds[0]);
+
+            for (int fd : read_fds)
+                close(fd);
+
+            run_worker(tests, schedule, queue, worker_idx, fds[1],
+                       test_timeout);
+        }
+
+        close(fds[1]);
+        pids.push_back(pid);
+        read_fds.push_back(fds[0]);
+    }
+
+    // Collect rows, and write them in serial order
+    vector<optional<vector<string>>> rows(n_tests);
+    vector<string> buffers(n_jobs);
+    size_t next_row = 0;
+
+    vector<pollfd> poll_fds;
+    for (int fd : read_fds)
+        poll_fds.push_back({fd, POLLIN, 0});
+
+    size_t n_open = n_jobs;
+    char read_buffer[1 << 16];
+
+    while (n_open > 0)
+    {
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0)
+        {
+            THROW_ASSERT(errno == EINTR, "Failed to poll test workers");
+            continue;
+        }
+
+        for (size_t worker_idx = 0; worker_idx < n_jobs; worker_idx++)
+        {
+            pollfd& pfd = poll_fds[worker_idx];
+
+            if (pfd.fd < 0 || pfd.revents == 0)
+                continue;
+
+            const ssize_t n_read = read(pfd.fd, read_buffer,
+                                        sizeof(read_buffer));
+
+            if (n_read < 0)
+            {
+                THROW_ASSERT(errno == EINTR, "Failed to read test results");
+                continue;
+            }
+
+            if (n_read == 0)
+            {
+                close(pfd.fd);
+                pfd.fd = -1;
+                n_open--;
+                continue;
+            }
+
+            string& buffer = buffers[worker_idx];
+            buffer.append(read_buffer, n_read);
+
+            uint64_t test_idx;
+            vector<string> row_fields;
+
+            while (decode_row(buffer, test_idx, row_fields))
+            {
+                THROW_ASSERT(test_idx < n_tests && !rows[test_idx]);
+                rows[test_idx] = std::move(row_fields);
+            }
+        }
+
+        while (next_row < n_tests && rows[next_row].has_value())
+        {
+            const pending_test& test = tests[next_row];
+            cout << test.file_name << " " << test.file_test_idx << endl;
+
+            write_csv_field_strings(outfile, *rows[next_row]);
+            rows[next_row].reset();
+            next_row++;
+        }
+    }
+
+    string worker_errors;
+
+    for (size_t worker_idx = 0; worker_idx < n_jobs; worker_idx++)
+    {
+        int status;
+
+        while (waitpid(pids[worker_idx], &status, 0) < 0)
+            THROW_ASSERT(errno == EINTR, "Failed to wait for test worker");
+
+        // i.e. killed when out of memory
+        if (WIFSIGNALED(status))
+            worker_errors += " Test worker " + to_string(worker_idx) +
+                             " killed by signal " +
+                             to_string(WTERMSIG(status)) + ".";
+        else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            worker_errors += " Test worker " + to_string(worker_idx) +
+                             " failed.";
+    }
+
+    munmap(ranges, ranges_size);
+
+    THROW_ASSERT(worker_errors.empty(),
+                 "Parallel autotests failed:" + worker_errors);
+    THROW_ASSERT(next_row == n_tests || exit_signal::mcgs_should_stop());
+}
+#endif
+
+} // namespace
@@ -1,11 +1,24 @@
 /*
     Invoked by ./MCGS --run-tests
+
+    With n_jobs > 1, test cases run in n_jobs forked worker processes, which
+    take them from a test_work_queue (hardest first, by number of moves). The
+    ttables are cleared before each test case (as with --clear-tt), and rows
+    are written in the serial order, so the CSV file matches a serial
+    --clear-tt run apart from timing, and from results which depend on the
+    timeout.
+
+    Game type IDs are assigned when a type is first used, and are part of
+    hashes. All test files are parsed before workers start, and types first
+    created during a search get different IDs than in a serial run, so
+    ttable statistics and node counts may differ slightly for those games
 */
 #pragma once
 #include "test_filter.h"
 #include <string>
+#include <cstddef>
 
 void run_autotests(const std::string& test_directory,
                    const std::string& outfile_name,
                    unsigned long long test_timeout,
-                   test_filter_enum filter_type);
+                   test_filter_enum filter_type, size_t n_jobs = 1);
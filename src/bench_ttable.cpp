@@ -0,0 +1,151 @@
+#include "bench_ttable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <type_traits>
+
+#include "hashing.h"
+#include "stopwatch.h"
+#include "transposition.h"
+#include "transposition_concurrent.h"
+
+using namespace std;
+
+namespace {
+
+// Same shapes as ttable_sumgame_entry and impartial_ttable_entry
+struct bench_entry_empty
+{
+};
+
+struct bench_entry_int
+{
+    int value;
+};
+
+constexpr size_t N_PROBES = size_t(1) << 24;
+constexpr size_t MAX_WARMUP_PROBES = size_t(1) << 25;
+
+// splitmix64 finalizer
+inline hash_t mix_hash(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// xorshift64
+inline uint64_t next_random(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+struct probe_result
+{
+    double probes_per_second;
+    double hit_rate;
+};
+
+// Empty entries use a bool, like sumgame. Others use the entry itself
+template <class Entry, class Table>
+inline void probe_once(Table& tt, hash_t hash, size_t& n_hits,
+                       uint64_t& checksum)
+{
+    typename Table::search_result sr = tt.search(hash);
+
+    if (sr.entry_valid())
+    {
+        n_hits++;
+
+        if constexpr (std::is_empty_v<Entry>)
+            checksum += sr.get_bool(0);
+        else
+            checksum += sr.get_entry().value;
+
+        return;
+    }
+
+    if constexpr (std::is_empty_v<Entry>)
+    {
+        sr.init_entry();
+        sr.set_bool(0, hash & 1);
+    }
+    else
+        sr.set_entry({static_cast<int>(hash)});
+}
+
+template <class Entry, class Table>
+probe_result run_probes(Table& tt, size_t index_bits)
+{
+    const uint64_t working_set_mask =
+        (uint64_t(1) << min<size_t>(index_bits + 1, 63)) - 1;
+
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    size_t n_hits = 0;
+    uint64_t checksum = 0;
+
+    const size_t n_warmup =
+        min<size_t>(MAX_WARMUP_PROBES, size_t(1) << index_bits);
+
+    for (size_t i = 0; i < n_warmup; i++)
+        probe_once<Entry>(tt, mix_hash(next_random(state) & working_set_mask),
+                          n_hits, checksum);
+
+    n_hits = 0;
+
+    stopwatch sw;
+    sw.start();
+
+    for (size_t i = 0; i < N_PROBES; i++)
+        probe_once<Entry>(tt, mix_hash(next_random(state) & working_set_mask),
+                          n_hits, checksum);
+
+    sw.stop();
+
+    // Keep the compiler from dropping the reads
+    if (checksum == 1)
+        cout << "";
+
+    const double seconds = sw.get_duration_ms() / 1000.0;
+
+    return {N_PROBES / seconds, ((double) n_hits) / N_PROBES};
+}
+
+template <template <class> class Table, class Entry>
+void bench_one(const string& layout_name, const string& entry_name,
+               size_t index_bits)
+{
+    const size_t n_bools = std::is_empty_v<Entry> ? 1 : 0;
+    Table<Entry> tt(index_bits, n_bools);
+
+    const probe_result result = run_probes<Entry>(tt, index_bits);
+
+    cout << index_bits << "," << layout_name << "," << entry_name << ",";
+    tt.print_size_estimate(cout);
+    cout << "," << (size_t) result.probes_per_second << ","
+         << result.hit_rate << endl;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////
+void bench_ttable(size_t index_bits)
+{
+    cout << "index bits,layout,entry,size,probes/s,hit rate" << endl;
+
+    bench_one<ttable, bench_entry_empty>("separate arrays", "empty",
+                                         index_bits);
+    bench_one<concurrent_ttable, bench_entry_empty>("64B buckets", "empty",
+                                                    index_bits);
+
+    bench_one<ttable, bench_entry_int>("separate arrays", "int", index_bits);
+    bench_one<concurrent_ttable, bench_entry_int>("64B buckets", "int",
+                                                  index_bits);
+}
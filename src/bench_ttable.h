@@ -0,0 +1,18 @@
+/*
+    Micro-benchmark for transposition table layouts. See --bench-ttable in
+    `./MCGS --help`
+*/
+#pragma once
+
+#include <cstddef>
+
+/*
+    Compares probes per second of ttable<Entry> (separate tag, bool, and entry
+    arrays) and concurrent_ttable<Entry> (64 byte buckets), for tables with
+    the given number of index bits.
+
+    Probes follow the sumgame search pattern: look up a hash, and on a miss,
+    initialize the entry. Hashes are drawn from a working set twice as large
+    as the table.
+*/
+void bench_ttable(size_t index_bits);
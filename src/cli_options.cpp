@@ -15,7 +15,10 @@
 #include "search_graph_debug.h"
 #include "paths.h"
 #include "string_to_int.h"
+#include "sumgame_move_ordering.h"
+#include "sumgame_search.h"
 #include "test_filter.h"
+#include "transposition_concurrent.h"
 #include "utilities.h"
 #include <cassert>
 
@@ -28,6 +31,7 @@ cli_options::cli_options()
       dry_run(false),
       should_exit(false),
       gen_experiments(false),
+      bench_ttable_idx_bits(),
       run_tests(false),
       //run_tests_stdin(false),
       use_player(false),
@@ -36,6 +40,7 @@ cli_options::cli_options()
       test_directory(get_default_input_path()),
       outfile_name(get_default_csv_path()),
       test_timeout(cli_options::DEFAULT_TEST_TIMEOUT),
+      test_jobs(1),
       play_log_name(),
       db_file_name(),
       init_database_type(INIT_DATABASE_AUTO),
@@ -145,6 +150,50 @@ void print_help_message(const string& exec_name)
         "table. Must be at least 1. Default: " +
             global::tt_imp_sumgame_idx_bits.get_default_str() + ".");
 
+    print_flag(global::tt_dfpn_idx_bits.flag() + " <# index bits>",
+               "How many index bits to use for the proof number "
+               "transposition table of --search-algorithm dfpn. Must be at "
+               "least 4. Default: " +
+                   global::tt_dfpn_idx_bits.get_default_str() + ".");
+
+    print_flag(global::tt_replacement.flag() + " <policy>",
+               "Which entry to evict when a ttable bucket is full. One of "
+               "\"always\", \"depth\" (keep entries nearest the root), "
+               "\"subtree\" (keep entries with the largest search subtrees), "
+               "or \"two-tier\" (half of each bucket by subtree size, half "
+               "always replaced). Default: " +
+                   global::tt_replacement.get_default_str() + ".");
+
+    print_flag(global::search_algorithm.flag() + " <algorithm>",
+               "Algorithm used to solve sums. One of \"minimax\" (boolean "
+               "minimax search) or \"dfpn\" (depth-first proof-number "
+               "search, which expands the subtree that looks easiest to "
+               "solve first). Default: " +
+                   global::search_algorithm.get_default_str() + ".");
+
+    print_flag(global::move_ordering.flag() + " <heuristics>",
+               "Move ordering used by --search-algorithm minimax. Either "
+               "\"none\" (moves in the order generated), \"all\", or a "
+               "comma separated list of: \"tt\" (moves to positions known "
+               "from the transposition table first), \"killer\" (moves "
+               "which won at the same depth first), \"db\" (rank moves "
+               "within each subgame by the database outcome classes and "
+               "temperatures of the resulting subgames). Default: " +
+                   global::move_ordering.get_default_str() + ".");
+
+    print_flag(global::iterative_deepening.flag(),
+               "Solve partisan test cases by minimax searches of each root "
+               "move, doubling the depth limit of the searches until the sum "
+               "is solved, and keeping the transposition table between "
+               "them. Ignores --search-algorithm. Default: " +
+                   global::iterative_deepening.get_default_str() + ".");
+
+    print_flag(global::threads.flag() + " <# threads>",
+               "How many threads to use for partisan search. Root moves are "
+               "divided between worker threads, and search stops as soon as "
+               "one finds a winning move. 1 means serial search. Default: " +
+                   global::threads.get_default_str() + ".");
+
     print_flag(global::use_db.no_flag(), "Disable database usage.");
 
     print_flag(global::use_seg.no_flag(),
@@ -161,6 +210,33 @@ void print_help_message(const string& exec_name)
                "Create and populate a new database file. See README for "
                "details on config string syntax.");
 
+    print_flag("--db-file-extend <file name> <config string>",
+               "Load a database file, generate the entries for the config "
+               "string which it doesn't already have, and save it back to "
+               "the same file. Existing entries and their links are kept, "
+               "and the config string is appended to the file's metadata.");
+
+    print_flag(global::db_gen_threads.flag() + " <# threads>",
+               "How many threads to use for partisan DB entry bounds and "
+               "dominated moves, when using minimax search. The created "
+               "database file is the same for any number of threads. "
+               "Default: " +
+                   global::db_gen_threads.get_default_str() + ".");
+
+    print_flag(global::db_file_indexed.flag(),
+               "Save the file created by --db-file-create or --db-file-extend "
+               "in the indexed format. Loading an indexed file maps it, and "
+               "decodes partisan entries when they're first looked up. "
+               "--db-file-load detects the format, and --db-file-extend keeps "
+               "indexed files indexed.");
+
+    print_flag(global::db_memory_budget.flag() + " <MiB>",
+               "When the loaded database file is indexed, evict the least "
+               "recently used game types' entries between test cases, until "
+               "the rest fit in this many MiB. Evicted game types are loaded "
+               "again when needed. 0 means no limit. Default: " +
+                   global::db_memory_budget.get_default_str() + ".");
+
     print_flag(
         global::pitm.no_flag(),
         "Disable \"play in the middle\" heuristic. By default, each subgame's "
@@ -189,6 +265,13 @@ void print_help_message(const string& exec_name)
                "completed), write impartial transposition table to specified "
                "file.");
 
+    print_flag(global::tt_mmap.flag(),
+               "Load ttable files by mapping them copy-on-write, instead of "
+               "reading them. Loading takes the same time for any table size, "
+               "and processes loading the same file share its unchanged "
+               "pages. Changes are never written back to the file. On "
+               "Windows, files are read instead.");
+
     print_flag(global::impartial_algorithm_mex.flag(),
                "Use Mex search algorithm for impartial games. NOTE: doesn't "
                "use the database during search.");
@@ -222,6 +305,12 @@ void print_help_message(const string& exec_name)
     print_flag("--gen-experiments", "Generate .test file for ICGA paper. See "
                                     "gen_experiments.cpp");
 
+    print_flag("--bench-ttable <# index bits>",
+               "Measure transposition table probes per second, for each "
+               "table layout, with the given number of index bits. Values of "
+               "24 to 32 are typical for real searches. Uses up to 16 bytes "
+               "per entry. Then exit.");
+
     print_flag(global::experiment_seed.flag() + " <seed>",
                "Set seed for experiment data "
                "generation. 0 means seed with current time. Default: " +
@@ -280,6 +369,17 @@ void print_help_message(const string& exec_name)
 milliseconds. Timeout of 0 means tests never time out. Default is " +
                    to_string(cli_options::DEFAULT_TEST_TIMEOUT) + ".");
 
+    print_flag("--test-jobs <# processes>",
+               "Run --run-tests in parallel worker processes, taking test "
+               "cases from a work-stealing queue ordered by predicted "
+               "difficulty. Implies " + global::clear_tt.flag() + ", and "
+               "writes the same CSV as a serial run with it, apart from "
+               "timing columns and tests whose result depends on the "
+               "timeout. Each worker has its own transposition tables, so "
+               "memory use grows with the number of workers (see "
+               "--tt-sumgame-idx-bits). Not supported on Windows or "
+               "WebAssembly. Default is 1.");
+
     // Remove these? Keep them in this separate section instead?
     cout << "Debugging flags:" << endl;
 
@@ -302,6 +402,10 @@ milliseconds. Timeout of 0 means tests never time out. Default is " +
     print_flag(global::print_ttable_size.flag(),
                "Print ttable size to stdout.");
 
+    print_flag(global::print_ttable_stats.flag(),
+               "Print ttable store counts (inserts, overwrites, evictions, "
+               "rejections) to stdout before exiting.");
+
     print_flag(global::print_db_info.flag(),
                "Print verbose database info to stdout. Includes metadata of "
                "loaded database file");
@@ -521,6 +625,52 @@ cli_options parse_args(int argc, const char** argv, bool silent)
             continue;
         }
 
+        if (arg == global::tt_mmap.flag())
+        {
+            global::tt_mmap.set(true);
+            continue;
+        }
+
+        if (arg == global::db_file_indexed.flag())
+        {
+            global::db_file_indexed.set(true);
+            continue;
+        }
+
+        if (arg == global::db_memory_budget.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::db_memory_budget.flag() +
+                                            " but no value");
+            }
+
+            unsigned long long budget_mib;
+
+            try
+            {
+                budget_mib = str_to_ull(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception(
+                    "Error: " + global::db_memory_budget.flag() +
+                    " value not an unsigned integer, or out of range");
+            }
+
+            global::db_memory_budget.set(budget_mib);
+            continue;
+        }
+
+        if (arg == global::print_ttable_stats.flag())
+        {
+            global::print_ttable_stats.set(true);
+            continue;
+        }
+
         if (arg == global::print_db_info.flag())
         {
             global::print_db_info.set(true);
@@ -592,6 +742,35 @@ cli_options parse_args(int argc, const char** argv, bool silent)
             continue;
         }
 
+        if (arg == "--bench-ttable")
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+                throw cli_options_exception(
+                    "Error: got --bench-ttable but no value");
+
+            unsigned short n_index_bits;
+
+            try
+            {
+                n_index_bits = str_to_ush(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception(
+                    "Error: --bench-ttable value not an unsigned integer, or "
+                    "out of range");
+            }
+
+            if (n_index_bits < 4 || n_index_bits > 40)
+                throw cli_options_exception(
+                    "Error: --bench-ttable value must be between 4 and 40");
+
+            opts.bench_ttable_idx_bits = n_index_bits;
+            continue;
+        }
+
         if (arg == "--run-tests")
         {
             opts.run_tests = true;
@@ -658,6 +837,38 @@ cli_options parse_args(int argc, const char** argv, bool silent)
             continue;
         }
 
+        if (arg == "--test-jobs")
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception(
+                    "Error: got --test-jobs but no value");
+            }
+
+            unsigned long long n_jobs;
+
+            try
+            {
+                n_jobs = str_to_ull(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception("Error: --test-jobs value not an "
+                        "unsigned integer, or out of range");
+            }
+
+            if (n_jobs < 1 || n_jobs > 1024)
+            {
+                throw cli_options_exception(
+                    "Error: --test-jobs value must be between 1 and 1024");
+            }
+
+            opts.test_jobs = n_jobs;
+            continue;
+        }
+
         if (arg == global::clear_tt.flag())
         {
             global::clear_tt.set(true);
@@ -765,6 +976,170 @@ cli_options parse_args(int argc, const char** argv, bool silent)
             continue;
         }
 
+        if (arg == global::tt_dfpn_idx_bits.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::tt_dfpn_idx_bits.flag() +
+                                            " but no value");
+            }
+
+            unsigned short n_index_bits;
+
+            try
+            {
+                n_index_bits = str_to_ush(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception(
+                    "Error: " + global::tt_dfpn_idx_bits.flag() +
+                    " value not an unsigned integer, or out of range");
+            }
+
+            if (n_index_bits < 4)
+                throw cli_options_exception(
+                    "Error: " + global::tt_dfpn_idx_bits.flag() +
+                    " value must be at least 4");
+
+            global::tt_dfpn_idx_bits.set(n_index_bits);
+            continue;
+        }
+
+        if (arg == global::search_algorithm.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::search_algorithm.flag() +
+                                            " but no value");
+            }
+
+            if (!sumgame_search_algorithm_from_string(arg_next).has_value())
+                throw cli_options_exception(
+                    "Error: unknown " + global::search_algorithm.flag() +
+                    " value \"" + arg_next + "\"");
+
+            global::search_algorithm.set(arg_next);
+            continue;
+        }
+
+        if (arg == global::move_ordering.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::move_ordering.flag() +
+                                            " but no value");
+            }
+
+            if (!move_ordering_from_string(arg_next).has_value())
+                throw cli_options_exception(
+                    "Error: unknown " + global::move_ordering.flag() +
+                    " value \"" + arg_next + "\"");
+
+            global::move_ordering.set(arg_next);
+            continue;
+        }
+
+        if (arg == global::iterative_deepening.flag())
+        {
+            global::iterative_deepening.set(true);
+            continue;
+        }
+
+        if (arg == global::tt_replacement.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::tt_replacement.flag() +
+                                            " but no value");
+            }
+
+            if (!ttable_replacement_policy_from_string(arg_next).has_value())
+                throw cli_options_exception(
+                    "Error: unknown " + global::tt_replacement.flag() +
+                    " value \"" + arg_next + "\"");
+
+            global::tt_replacement.set(arg_next);
+            continue;
+        }
+
+        if (arg == global::threads.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::threads.flag() +
+                                            " but no value");
+            }
+
+            unsigned short n_threads;
+
+            try
+            {
+                n_threads = str_to_ush(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception(
+                    "Error: " + global::threads.flag() +
+                    " value not an unsigned integer, or out of range");
+            }
+
+            if (n_threads == 0)
+                throw cli_options_exception("Error: " + global::threads.flag() +
+                                            " value must be at least 1");
+
+            global::threads.set(n_threads);
+            continue;
+        }
+
+        if (arg == global::db_gen_threads.flag())
+        {
+            arg_idx++;
+
+            if (arg_next.size() == 0)
+            {
+                throw cli_options_exception("Error: got " +
+                                            global::db_gen_threads.flag() +
+                                            " but no value");
+            }
+
+            unsigned short n_threads;
+
+            try
+            {
+                n_threads = str_to_ush(arg_next);
+            }
+            catch (const exception& exc)
+            {
+                throw cli_options_exception(
+                    "Error: " + global::db_gen_threads.flag() +
+                    " value not an unsigned integer, or out of range");
+            }
+
+            if (n_threads == 0)
+                throw cli_options_exception(
+                    "Error: " + global::db_gen_threads.flag() +
+                    " value must be at least 1");
+
+            global::db_gen_threads.set(n_threads);
+            continue;
+        }
+
         if (arg == global::use_db.no_flag())
         {
             global::use_db.set(false);
@@ -828,6 +1203,31 @@ cli_options parse_args(int argc, const char** argv, bool silent)
             continue;
         }
 
+        if (arg == "--db-file-extend")
+        {
+            const int arg_idx_config_string = arg_idx + 2;
+            arg_idx += 2;
+
+            if (arg_next.empty())
+                throw cli_options_exception(
+                    "Error: --db-file-extend but no file name given");
+
+            if (arg_idx_config_string >= arg_n)
+                throw cli_options_exception(
+                    "Error: --db-file-extend but no config string given");
+
+            if (opts.init_database_type != INIT_DATABASE_AUTO)
+                throw cli_options_exception(
+                    "Error: --db-file-extend used, but another \"--db-file*\" "
+                    "option already used");
+
+            opts.init_database_type = INIT_DATABASE_EXTEND;
+            opts.db_file_name = arg_next;
+            opts.db_config_string = args[arg_idx_config_string];
+
+            continue;
+        }
+
         if (arg == global::pitm.no_flag())
         {
             assert(global::pitm());
@@ -8,6 +8,7 @@
 #include <string>
 #include <exception>
 #include <optional>
+#include <cstddef>
 
 #include "init_database.h"
 #include "test_filter.h"
@@ -34,6 +35,8 @@ struct cli_options
 
     bool gen_experiments;
 
+    std::optional<size_t> bench_ttable_idx_bits; // Run ttable benchmark
+
     bool run_tests;       // Run autotests
     //bool run_tests_stdin; // Run autotests from stdin
 
@@ -45,6 +48,7 @@ struct cli_options
     std::string test_directory;
     std::string outfile_name;        // CSV output file
     unsigned long long test_timeout; // ms
+    size_t test_jobs;                // Worker processes for --run-tests
 
     std::string play_log_name;
 
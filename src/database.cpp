@@ -13,7 +13,15 @@
 #include <cstddef>
 #include <memory>
 #include <iostream>
+#include <exception>
 
+#ifndef __EMSCRIPTEN__
+#include <atomic>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "db_indexed_file.h"
 #include "db_link_t.h"
 #include "db_make_simplest_equal_game.h"
 #include "exit_signal.h"
@@ -34,6 +42,9 @@
 #include "impartial_sumgame.h"
 #include "impartial_game.h"
 #include "sumgame.h"
+#include "sumgame_search.h"
+#include "search_graph_debug.h"
+#include "hashing.h"
 #include "iobuffer.h"
 #include "db_game_generator.h"
 #include "db_entry_serializers.h" // IWYU pragma: keep
@@ -330,14 +341,141 @@ vector<game*> db_entry_partisan::load_sum() const
     return serializer<vector<game*>>::load(is, nullptr);
 }
 
+////////////////////////////////////////////////// pending partisan entries
+namespace database_impl {
+/*
+    Entry generated up to its outcome class during parallel generation (see
+    database::generate_entries_partisan()). Owns clones of the sum's active
+    games, so that the sum can be rebuilt later
+*/
+struct pending_partisan_entry
+{
+    pending_partisan_entry(pair<const hash_t, db_entry_partisan>* entry_pair,
+                           const sumgame& sum);
+
+    void load_sum(sumgame& sum) const;
+    void unload_sum(sumgame& sum) const;
+
+    pair<const hash_t, db_entry_partisan>* entry_pair;
+    vector<unique_ptr<game>> games;
+    bw to_play;
+
+    // Entries only depend on entries of lower layers
+    size_t layer;
+
+    // Computed by a worker thread, then copied to the entry
+    shared_ptr<game_bounds> bounds_data;
+    shared_ptr<db_dom_moves_t> dominated_moves;
+    uint64_t complexity;
+};
+
+pending_partisan_entry::pending_partisan_entry(
+    pair<const hash_t, db_entry_partisan>* entry_pair, const sumgame& sum)
+    : entry_pair(entry_pair), to_play(sum.to_play()), layer(0), complexity(0)
+{
+    const int n_games = sum.num_total_games();
+    for (int i = 0; i < n_games; i++)
+    {
+        const game* g = sum.subgame_const(i);
+        if (g->is_active())
+            games.emplace_back(g->clone());
+    }
+}
+
+void pending_partisan_entry::load_sum(sumgame& sum) const
+{
+    assert(sum.num_total_games() == 0);
+
+    for (const unique_ptr<game>& g : games)
+        sum.add(g.get());
+
+    sum.set_to_play(to_play);
+}
+
+void pending_partisan_entry::unload_sum(sumgame& sum) const
+{
+    for (auto it = games.rbegin(); it != games.rend(); it++)
+        sum.pop(it->get());
+
+    assert(sum.num_total_games() == 0);
+}
+
+} // namespace database_impl
+
+////////////////////////////////////////////////// indexed segment state
+namespace database_impl {
+// Decoded entries of one segment of the loaded indexed file
+struct indexed_segment_state
+{
+    indexed_segment_state(size_t n_segments);
+
+    vector<hash_t> decoded_hashes;
+
+    // Estimate of memory used by decoded entries
+    uint64_t n_decoded_bytes;
+
+    uint64_t last_use;
+
+    // Segments with entries linking into this segment
+    vector<bool> dependents;
+};
+
+indexed_segment_state::indexed_segment_state(size_t n_segments)
+    : n_decoded_bytes(0), last_use(0), dependents(n_segments, false)
+{
+}
+
+} // namespace database_impl
+
+namespace {
+bool use_parallel_generation(const db_gen_options_t& gen_opts)
+{
+#ifdef __EMSCRIPTEN__
+    return false;
+#else
+    /*
+        Workers share the minimax ttable, like sumgame::_solve_root_split().
+        Other search algorithms aren't thread safe
+    */
+    return (gen_opts.n_threads > 1) &&                                    //
+           (gen_opts.stop_after >= DB_GEN_STOP_AFTER_BOUNDS) &&           //
+           (get_global_search_algorithm() == SUMGAME_SEARCH_MINIMAX) &&   //
+           !sgraph::is_recording();                                       //
+#endif
+}
+
+} // namespace
+
 ////////////////////////////////////////////////// database methods
 database::database()
-    : _n_entries_generated(0), _graph_cache(make_unique<thermograph_cache>())
+    : _n_entries_generated(0),
+      _pending_partisan(nullptr),
+      _indexed_mutex(make_unique<mutex>()),
+      _n_indexed_decoded(0),
+      _indexed_use_counter(0),
+      _graph_cache(make_unique<thermograph_cache>())
 {
 }
 
-void database::save(const string& filename) const
+database::~database()
 {
+}
+
+database::database(database&& other) = default;
+database& database::operator=(database&& other) = default;
+
+void database::save(const string& filename, db_file_format format) const
+{
+    _decode_all_indexed();
+
+    if (format == DB_FILE_FORMAT_INDEXED)
+    {
+        _save_indexed(filename);
+        return;
+    }
+
+    assert(format == DB_FILE_FORMAT_STREAM);
+
     file_obuffer os(filename);
     serializer_ctx ctx;
 
@@ -359,6 +497,13 @@ void database::load(const string& filename)
 {
     assert(_terminal_partisan.empty());
     assert(_tree_impartial.empty());
+    assert(_indexed_file.get() == nullptr);
+
+    if (db_indexed_file::is_indexed_file(filename))
+    {
+        _load_indexed(filename);
+        return;
+    }
 
     file_ibuffer is(filename);
     serializer_ctx ctx;
@@ -382,6 +527,7 @@ void database::load(const string& filename)
 void database::dump_to_stream(ostream& os) const
 {
     CHECK_EXIT_SIGNAL_0();
+    _decode_all_indexed();
     os << _mapper << '\n';
 
     for (const pair<const hash_t, db_entry_partisan>& entry_pair :
@@ -508,12 +654,7 @@ pair<const hash_t, db_entry_partisan>* database::get_partisan_ptr_pair(
 pair<const hash_t, db_entry_partisan>* database::get_partisan_ptr_pair(
     hash_t hash)
 {
-    auto pair_iterator = _terminal_partisan.find(hash);
-    if (pair_iterator == _terminal_partisan.end())
-        return nullptr;
-
-    pair<const hash_t, db_entry_partisan>& p = *pair_iterator;
-    return &p;
+    return _find_partisan(hash, 0);
 }
 
 pair<const hash_t, db_entry_partisan>* database::get_partisan_ptr_pair(
@@ -583,6 +724,17 @@ void database::set_impartial(const game& g, const db_entry_impartial& entry)
 void database::generate_entries_partisan(i_db_game_generator& gen,
                                          const db_gen_options_t& gen_opts)
 {
+    vector<database_impl::pending_partisan_entry> pending;
+
+    assert(_pending_partisan == nullptr);
+    if (use_parallel_generation(gen_opts))
+        _pending_partisan = &pending;
+
+    call_func_on_destruction reset_pending([&]() -> void
+    {
+        _pending_partisan = nullptr;
+    });
+
     sumgame sum1(BLACK);
     sumgame sum2(BLACK);
 
@@ -622,14 +774,23 @@ void database::generate_entries_partisan(i_db_game_generator& gen,
         sum1.pop(g.get());
     }
 
+    if (_pending_partisan != nullptr)
+    {
+        _pending_partisan = nullptr;
+        _finish_pending_partisan_entries(pending, gen_opts);
+    }
+
     delete_equivalence_classes();
 }
 
 void database::generate_single_partisan_entry(sumgame& sum,
                                               const db_gen_options_t& gen_opts)
 {
-    db_entry_partisan* entry = get_or_allocate_partisan_ptr(sum);
-    assert(entry != nullptr);
+    pair<const hash_t, db_entry_partisan>* entry_pair =
+        _get_or_allocate_partisan_impl(sum);
+    assert(entry_pair != nullptr);
+
+    db_entry_partisan* entry = &entry_pair->second;
 
     /*
         TODO `get_or_allocate...` should instead report whether or not the
@@ -704,6 +865,13 @@ void database::generate_single_partisan_entry(sumgame& sum,
     if (gen_opts.stop_after == DB_GEN_STOP_AFTER_OUTCOME_CLASS)
         return;
 
+    // Finished by _finish_pending_partisan_entries()
+    if (_pending_partisan != nullptr)
+    {
+        _pending_partisan->emplace_back(entry_pair, sum);
+        return;
+    }
+
     // Bounds
     entry->bounds_data = db_make_bounds(*this, sum, *entry);
     assert(entry->bounds_data && entry->bounds_data->both_valid());
@@ -724,6 +892,192 @@ void database::generate_single_partisan_entry(sumgame& sum,
     assert(gen_opts.stop_after == DB_GEN_STOP_AFTER_SEG);
 }
 
+void database::_finish_pending_partisan_entries(
+    vector<database_impl::pending_partisan_entry>& pending,
+    const db_gen_options_t& gen_opts)
+{
+#ifdef __EMSCRIPTEN__
+    THROW_ASSERT(pending.empty());
+#else
+    using database_impl::pending_partisan_entry;
+
+    const bool make_dom = gen_opts.stop_after >= DB_GEN_STOP_AFTER_DOMINATED_MOVES;
+
+    sumgame sum(BLACK);
+    size_t n_layers = 0;
+
+    /*
+        Assign layers. Entries are pending in the order they were finished,
+        so children come before their parents. Other children are complete
+    */
+    {
+        unordered_map<const db_entry_partisan*, size_t> pending_idx;
+
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            pending_partisan_entry& p = pending[i];
+            pending_idx.emplace(&p.entry_pair->second, i);
+
+            p.load_sum(sum);
+
+            for (const bw player : {BLACK, WHITE})
+            {
+                sum.set_to_play(player);
+                unique_ptr<sumgame_move_generator> gen(
+                    sum.create_sum_move_generator(player));
+
+                for (; *gen; ++(*gen))
+                {
+                    sum.play_sum(gen->gen_sum_move(), player);
+
+                    const db_entry_partisan* child = get_partisan_ptr(sum);
+                    THROW_ASSERT(child != nullptr);
+
+                    auto it = pending_idx.find(child);
+                    if (it != pending_idx.end())
+                    {
+                        THROW_ASSERT(it->second < i);
+                        p.layer = max(p.layer, pending[it->second].layer + 1);
+                    }
+                    else
+                        THROW_ASSERT(child->bounds_data &&
+                                     (!make_dom || child->dominated_moves));
+
+                    sum.undo_move();
+                }
+            }
+
+            p.unload_sum(sum);
+            n_layers = max(n_layers, p.layer + 1);
+        }
+    }
+
+    /*
+        Bounds and dominated moves, one layer at a time. Workers only read
+        entries (also through the global database during search), so results
+        are copied to the entries between layers
+    */
+    const size_t restore_threads = global::threads();
+    call_func_on_destruction restore_globals([&]() -> void
+    {
+        random_table::set_growth_locked(false);
+        global::threads.set(restore_threads);
+    });
+
+    // Workers each search serially
+    global::threads.set(1);
+
+    /*
+        Random tables can't grow while workers read them. Sums gain subgames
+        during search, so reserve extra hash modifiers first
+    */
+    size_t max_games = 0;
+    for (const pending_partisan_entry& p : pending)
+        max_games = max(max_games, p.games.size());
+
+    get_global_random_table(RANDOM_TABLE_MODIFIER)
+        .reserve(max<size_t>(64, 8 * max_games));
+    random_table::set_growth_locked(true);
+
+    vector<vector<size_t>> layers(n_layers);
+    for (size_t i = 0; i < pending.size(); i++)
+        layers[pending[i].layer].push_back(i);
+
+    for (const vector<size_t>& layer : layers)
+    {
+        atomic<size_t> next_idx(0);
+        mutex mtx;
+        exception_ptr worker_exception;
+
+        auto worker = [&]() -> void
+        {
+            try
+            {
+                sumgame worker_sum(BLACK);
+
+                while (true)
+                {
+                    const size_t idx = next_idx.fetch_add(1);
+                    if (idx >= layer.size())
+                        break;
+
+                    pending_partisan_entry& p = pending[layer[idx]];
+                    const db_entry_partisan& entry = p.entry_pair->second;
+
+                    p.load_sum(worker_sum);
+
+                    p.bounds_data = db_make_bounds(*this, worker_sum, entry);
+
+                    if (make_dom)
+                    {
+                        db_entry_partisan dom_entry;
+                        db_make_dominated_moves(worker_sum, dom_entry, *this);
+
+                        p.dominated_moves = dom_entry.dominated_moves;
+                        p.complexity = dom_entry.complexity;
+                    }
+
+                    p.unload_sum(worker_sum);
+                }
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(mtx);
+
+                if (!worker_exception)
+                    worker_exception = current_exception();
+
+                // Stop other workers
+                next_idx.store(layer.size());
+            }
+        };
+
+        const size_t n_workers = min(gen_opts.n_threads, layer.size());
+
+        vector<thread> workers;
+        for (size_t i = 0; i < n_workers; i++)
+            workers.emplace_back(worker);
+
+        for (thread& t : workers)
+            t.join();
+
+        if (worker_exception)
+            rethrow_exception(worker_exception);
+
+        for (const size_t i : layer)
+        {
+            pending_partisan_entry& p = pending[i];
+            db_entry_partisan& entry = p.entry_pair->second;
+
+            entry.bounds_data = p.bounds_data;
+            assert(entry.bounds_data && entry.bounds_data->both_valid());
+
+            if (make_dom)
+            {
+                entry.dominated_moves = p.dominated_moves;
+                entry.complexity = p.complexity;
+                assert(entry.dominated_moves);
+            }
+        }
+    }
+
+    random_table::set_growth_locked(false);
+    global::threads.set(restore_threads);
+
+    if (gen_opts.stop_after != DB_GEN_STOP_AFTER_SEG)
+        return;
+
+    // Equivalence classes depend on the order of entries
+    for (const pending_partisan_entry& p : pending)
+    {
+        p.load_sum(sum);
+        db_make_simplest_equal_game(sum, p.entry_pair->second, gen_opts,
+                                    *this);
+        p.unload_sum(sum);
+    }
+#endif
+}
+
 void database::generate_entries_impartial(i_db_game_generator& gen, bool silent)
 {
     while (gen)
@@ -778,6 +1132,8 @@ void database::generate_entries_impartial(i_db_game_generator& gen, bool silent)
 
 void database::refine_partisan_links()
 {
+    _decode_all_indexed();
+
     for (pair<const hash_t, db_entry_partisan>& entry_pair : _terminal_partisan)
         db_refine_simplest_equal_game(entry_pair, *this);
 
@@ -787,6 +1143,55 @@ void database::refine_partisan_links()
     cout << ")" << endl;
 }
 
+void database::add_existing_entries_to_equivalence_classes(
+    game_type_t runtime_type)
+{
+    _decode_all_indexed();
+
+    const game_type_t disk_type = _mapper.translate_type(runtime_type);
+    if (disk_type == 0)
+        return;
+
+    vector<pair<const hash_t, db_entry_partisan>*> entries;
+
+    for (pair<const hash_t, db_entry_partisan>& entry_pair : _terminal_partisan)
+    {
+        const db_entry_partisan& entry = entry_pair.second;
+
+        if (entry.disk_game_type == disk_type &&
+            entry.size_score_type != DB_GEN_SIZE_SCORE_TYPE_NONE)
+            entries.push_back(&entry_pair);
+    }
+
+    /*
+        Entries linking to themselves first, so the others can join their
+        linked entry's class without searching. Sort by hash for a
+        deterministic order
+    */
+    auto links_to_self =
+        [](const pair<const hash_t, db_entry_partisan>* entry_pair) -> bool
+    {
+        return entry_pair->second.simplest_equal_entry.get_as_pointer() ==
+               entry_pair;
+    };
+
+    sort(entries.begin(), entries.end(),
+         [&](const pair<const hash_t, db_entry_partisan>* entry_pair1,
+             const pair<const hash_t, db_entry_partisan>* entry_pair2) -> bool
+    {
+        const bool self1 = links_to_self(entry_pair1);
+        const bool self2 = links_to_self(entry_pair2);
+
+        if (self1 != self2)
+            return self1;
+
+        return entry_pair1->first < entry_pair2->first;
+    });
+
+    for (pair<const hash_t, db_entry_partisan>* entry_pair : entries)
+        db_add_existing_entry_to_equivalence_class(*entry_pair, *this);
+}
+
 void database::report_size_score(game_type_t disk_type, uint64_t size_score)
 {
     assert(disk_type > 0);
@@ -814,15 +1219,61 @@ void database::clear()
     _max_size_scores.clear();
     _terminal_partisan.clear();
     _tree_impartial.clear();
+    _indexed_file.reset();
+    _n_indexed_decoded = 0;
+    _indexed_segments.clear();
 }
 
 bool database::empty() const
 {
-    return _terminal_partisan.empty() && _tree_impartial.empty();
+    return _n_partisan_entries() == 0 && _tree_impartial.empty();
+}
+
+void database::enforce_memory_budget(uint64_t budget_bytes)
+{
+    if (_indexed_file.get() == nullptr || budget_bytes == 0)
+        return;
+
+    lock_guard<mutex> lock(*_indexed_mutex);
+
+    const size_t n_segments = _indexed_segments.size();
+
+    while (true)
+    {
+        uint64_t n_used_bytes = 0;
+        optional<size_t> victim;
+
+        for (size_t i = 0; i < n_segments; i++)
+        {
+            const database_impl::indexed_segment_state& state =
+                _indexed_segments[i];
+
+            if (!_indexed_file->is_segment_loaded(i))
+            {
+                assert(state.decoded_hashes.empty());
+                continue;
+            }
+
+            n_used_bytes += state.n_decoded_bytes +
+                            _indexed_file->segment_n_owned_bytes(i);
+
+            if (!victim.has_value() ||
+                state.last_use < _indexed_segments[*victim].last_use)
+                victim = i;
+        }
+
+        if (n_used_bytes <= budget_bytes || !victim.has_value())
+            break;
+
+        _evict_segment_locked(*victim);
+    }
 }
 
 bool database::is_equal(const database& other) const
 {
+    _decode_all_indexed();
+    other._decode_all_indexed();
+
     if (_mapper != other._mapper)
         return false;
 
@@ -842,10 +1293,18 @@ bool database::is_equal(const database& other) const
     - MCGS version
     - Date created
     - Game config string
+    - For extended databases, one line per extension
 */
 void database::update_metadata_string(const string& config_string)
 {
-    _metadata_string.clear();
+    if (!_metadata_string.empty())
+    {
+        _metadata_string += "\nExtended: \"" + get_current_time_as_string() +
+                            "\" with version \"" +
+                            string(MCGS_VERSION_STRING) +
+                            "\", DB config string: \"" + config_string + "\"";
+        return;
+    }
 
     // TODO commit hash instead?
     _metadata_string += "Version: \"" + string(MCGS_VERSION_STRING) + "\"\n";
@@ -869,6 +1328,8 @@ void database::update_metadata_string(const string& config_string)
 
 void database::assert_links_equal(bool silent)
 {
+    _decode_all_indexed();
+
     if (!silent)
         cout << "Disabling `global::use_seg` for validation pass..." << endl;
 
@@ -1070,6 +1531,294 @@ void database::_convert_links_to_pointers()
     }
 }
 
+void database::_save_indexed(const string& filename) const
+{
+    assert(_indexed_file.get() == nullptr);
+
+    // Everything except partisan entries goes in the prefix
+    memory_obuffer prefix_os;
+    serializer_ctx ctx;
+
+    serializer_save(prefix_os, _metadata_string, &ctx);
+    serializer_save(prefix_os, _mapper, &ctx);
+    serializer_save(prefix_os, _graph_cache, &ctx);
+    serializer_save(prefix_os, _max_size_scores, &ctx);
+    serializer_save(prefix_os, _tree_impartial, &ctx);
+
+    const vector<uint8_t> prefix = prefix_os.release_data();
+
+    vector<const pair<const hash_t, db_entry_partisan>*> entries;
+    entries.reserve(_terminal_partisan.size());
+
+    for (const pair<const hash_t, db_entry_partisan>& entry_pair :
+         _terminal_partisan)
+        entries.push_back(&entry_pair);
+
+    db_indexed_file::write(filename, prefix, std::move(entries),
+                           _get_graph_cache());
+}
+
+void database::_load_indexed(const string& filename)
+{
+    _indexed_file.reset(new db_indexed_file(filename));
+    _n_indexed_decoded = 0;
+    _indexed_use_counter = 0;
+
+    const size_t n_segments = _indexed_file->n_segments();
+    _indexed_segments.assign(n_segments,
+                             database_impl::indexed_segment_state(n_segments));
+
+    range_ibuffer is(_indexed_file->prefix_data(),
+                     _indexed_file->prefix_size());
+    serializer_ctx ctx;
+
+    serializer_load(is, _metadata_string, &ctx);
+    serializer_load(is, _mapper, &ctx);
+    serializer_load(is, _graph_cache, &ctx);
+    serializer_load(is, _max_size_scores, &ctx);
+    serializer_load(is, _tree_impartial, &ctx);
+
+    THROW_ASSERT(is.bytes_read() == _indexed_file->prefix_size(),
+                 "Indexed DB file \"" + filename + "\" has invalid prefix!");
+}
+
+pair<const hash_t, db_entry_partisan>* database::_find_partisan(
+    hash_t hash, game_type_t disk_type) const
+{
+    if (_indexed_file.get() != nullptr)
+    {
+        lock_guard<mutex> lock(*_indexed_mutex);
+        return _find_or_decode_locked(hash, disk_type, disk_type != 0);
+    }
+
+    auto entry_iterator = _terminal_partisan.find(hash);
+    if (entry_iterator == _terminal_partisan.end())
+        return nullptr;
+
+    const pair<const hash_t, db_entry_partisan>& p = *entry_iterator;
+
+    pair<const hash_t, db_entry_partisan>& p_nonconst =
+        const_cast<pair<const hash_t, db_entry_partisan>&>(p);
+
+    return &p_nonconst;
+}
+
+pair<const hash_t, db_entry_partisan>* database::_find_or_decode_locked(
+    hash_t hash, game_type_t disk_type, bool exact_type) const
+{
+    assert(_indexed_file.get() != nullptr);
+    assert(LOGICAL_IMPLIES(exact_type, disk_type != 0));
+
+    terminal_layer_partisan_t& terminal_partisan =
+        const_cast<terminal_layer_partisan_t&>(_terminal_partisan);
+
+    auto entry_iterator = terminal_partisan.find(hash);
+    if (entry_iterator != terminal_partisan.end())
+    {
+        pair<const hash_t, db_entry_partisan>* entry_pair = &*entry_iterator;
+        _touch_segment_locked(entry_pair->second.disk_game_type);
+        return entry_pair;
+    }
+
+    if (hash == 0)
+        return nullptr;
+
+    const size_t n_segments = _indexed_file->n_segments();
+    const optional<size_t> type_segment =
+        _indexed_file->find_segment(disk_type);
+
+    /*
+        Search order: disk_type's segment, then loaded segments, then
+        segments not yet loaded
+    */
+    for (int pass = 0; pass < 3; pass++)
+    {
+        if (pass > 0 && exact_type)
+            break;
+
+        for (size_t i = 0; i < n_segments; i++)
+        {
+            const bool is_type_segment =
+                type_segment.has_value() && i == *type_segment;
+
+            const bool loaded = _indexed_file->is_segment_loaded(i);
+
+            const bool in_pass = (pass == 0 && is_type_segment) ||
+                                 (pass == 1 && !is_type_segment && loaded) ||
+                                 (pass == 2 && !is_type_segment && !loaded);
+
+            if (!in_pass)
+                continue;
+
+            _indexed_file->load_segment(i);
+
+            const optional<size_t> record_idx = _indexed_file->find(i, hash);
+            if (record_idx.has_value())
+                return _decode_record_locked(i, *record_idx);
+        }
+    }
+
+    return nullptr;
+}
+
+pair<const hash_t, db_entry_partisan>* database::_decode_record_locked(
+    size_t segment_idx, size_t record_idx) const
+{
+    assert(_indexed_file->is_segment_loaded(segment_idx));
+
+    terminal_layer_partisan_t& terminal_partisan =
+        const_cast<terminal_layer_partisan_t&>(_terminal_partisan);
+
+    const hash_t hash = _indexed_file->record_hash(segment_idx, record_idx);
+
+    auto inserted = terminal_partisan.emplace(
+        hash, _indexed_file->decode_record(segment_idx, record_idx,
+                                           _get_graph_cache()));
+    assert(inserted.second);
+    _n_indexed_decoded++;
+
+    // Map node, and the entry's variable size fields
+    database_impl::indexed_segment_state& state =
+        _indexed_segments[segment_idx];
+
+    state.decoded_hashes.push_back(hash);
+    state.n_decoded_bytes +=
+        sizeof(pair<const hash_t, db_entry_partisan>) + 3 * sizeof(void*) +
+        _indexed_file->record_arena_size(segment_idx, record_idx);
+    state.last_use = ++_indexed_use_counter;
+
+    /*
+        The new entry is already in the map, so links forming cycles
+        terminate
+    */
+    pair<const hash_t, db_entry_partisan>* entry_pair = &*inserted.first;
+    db_entry_partisan& entry = entry_pair->second;
+
+    auto convert_link = [&](db_link_t& link) -> void
+    {
+        pair<const hash_t, db_entry_partisan>* target = _find_or_decode_locked(
+            link.get_as_hash(), entry.disk_game_type, false);
+
+        link.set_as_pointer(target);
+
+        if (target == nullptr ||
+            target->second.disk_game_type == entry.disk_game_type)
+            return;
+
+        const optional<size_t> target_segment =
+            _indexed_file->find_segment(target->second.disk_game_type);
+        assert(target_segment.has_value());
+
+        _indexed_segments[*target_segment].dependents[segment_idx] = true;
+    };
+
+    convert_link(entry.simplest_equal_entry);
+
+    for (db_link_t& subgame_link : entry.subgame_links)
+        convert_link(subgame_link);
+
+    return entry_pair;
+}
+
+void database::_touch_segment_locked(game_type_t disk_type) const
+{
+    const optional<size_t> segment_idx =
+        _indexed_file->find_segment(disk_type);
+
+    if (segment_idx.has_value())
+        _indexed_segments[*segment_idx].last_use = ++_indexed_use_counter;
+}
+
+void database::_evict_segment_locked(size_t segment_idx)
+{
+    const size_t n_segments = _indexed_segments.size();
+
+    // Find dependents, transitively
+    vector<bool> evict(n_segments, false);
+    vector<size_t> stack {segment_idx};
+    evict[segment_idx] = true;
+
+    while (!stack.empty())
+    {
+        const size_t idx = stack.back();
+        stack.pop_back();
+
+        for (size_t i = 0; i < n_segments; i++)
+        {
+            if (_indexed_segments[idx].dependents[i] && !evict[i])
+            {
+                evict[i] = true;
+                stack.push_back(i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n_segments; i++)
+    {
+        if (!evict[i])
+            continue;
+
+        database_impl::indexed_segment_state& state = _indexed_segments[i];
+
+        for (const hash_t hash : state.decoded_hashes)
+            _terminal_partisan.erase(hash);
+
+        assert(_n_indexed_decoded >= state.decoded_hashes.size());
+        _n_indexed_decoded -= state.decoded_hashes.size();
+
+        state = database_impl::indexed_segment_state(n_segments);
+        _indexed_file->unload_segment(i);
+
+        for (database_impl::indexed_segment_state& other : _indexed_segments)
+            other.dependents[i] = false;
+    }
+}
+
+void database::_decode_all_indexed() const
+{
+    if (_indexed_file.get() == nullptr)
+        return;
+
+    lock_guard<mutex> lock(*_indexed_mutex);
+
+    const size_t n_segments = _indexed_file->n_segments();
+    for (size_t i = 0; i < n_segments; i++)
+    {
+        _indexed_file->load_segment(i);
+
+        const game_type_t disk_type = _indexed_file->segment_disk_type(i);
+        const size_t n_records = _indexed_file->segment_n_records(i);
+
+        for (size_t j = 0; j < n_records; j++)
+        {
+            pair<const hash_t, db_entry_partisan>* entry_pair =
+                _find_or_decode_locked(_indexed_file->record_hash(i, j),
+                                       disk_type, true);
+            assert(entry_pair != nullptr);
+        }
+    }
+
+    _indexed_file.reset();
+    _indexed_segments.clear();
+    _n_indexed_decoded = 0;
+}
+
+size_t database::_n_partisan_entries() const
+{
+    if (_indexed_file.get() == nullptr)
+        return _terminal_partisan.size();
+
+    lock_guard<mutex> lock(*_indexed_mutex);
+
+    size_t n_records = 0;
+
+    const size_t n_segments = _indexed_file->n_segments();
+    for (size_t i = 0; i < n_segments; i++)
+        n_records += _indexed_file->segment_n_records(i);
+
+    return _terminal_partisan.size() + n_records - _n_indexed_decoded;
+}
+
 game_type_t database::_get_sum_db_type(const sumgame& sum)
 {
     optional<game_type_t> sum_type;
@@ -1139,17 +1888,7 @@ pair<const hash_t, db_entry_partisan>* database::_get_partisan_impl(
         return nullptr;
 
     const hash_t hash = get_db_hash(g);
-
-    auto entry_iterator = _terminal_partisan.find(hash);
-    if (entry_iterator == _terminal_partisan.end())
-        return nullptr;
-
-    const pair<const hash_t, db_entry_partisan>& p = *entry_iterator;
-
-    pair<const hash_t, db_entry_partisan>& p_nonconst =
-        const_cast<pair<const hash_t, db_entry_partisan>&>(p);
-
-    return &p_nonconst;
+    return _find_partisan(hash, disk_type);
 }
 
 template <class Game_Or_Sum_T>
@@ -1172,6 +1911,9 @@ pair<const hash_t, db_entry_partisan>* database::_get_or_allocate_partisan_impl(
 
     const hash_t hash = get_db_hash(g);
 
+    // Entries not from the file can't be evicted, so decode everything
+    _decode_all_indexed();
+
     auto entry_iterator = _terminal_partisan.try_emplace(hash);
 
     pair<const hash_t, db_entry_partisan>& p = *entry_iterator.first;
@@ -1186,7 +1928,7 @@ ostream& operator<<(ostream& os, const database& db)
 
     //os << "# of Partisan game types: " << db._tree_partisan.size() << '\n';
 
-    os << "# of Partisan games: " << db._terminal_partisan.size() << '\n';
+    os << "# of Partisan games: " << db._n_partisan_entries() << '\n';
     os << "# of Impartial game types: " << db._tree_impartial.size() << '\n';
 
     //for (const pair<const game_type_t, database::terminal_layer_partisan_t>& p :
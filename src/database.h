@@ -8,8 +8,10 @@
 #pragma once
 #include <cassert>
 #include <cstdint>
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <array>
@@ -41,6 +43,12 @@
 
 
 class database;
+class db_indexed_file;
+
+namespace database_impl {
+struct pending_partisan_entry;
+struct indexed_segment_state;
+} // namespace database_impl
 
 ////////////////////////////////////////////////// Enums, options struct
 enum db_gen_stop_after_enum
@@ -97,7 +105,8 @@ struct db_gen_options_t
     db_gen_options_t()
         : silent(false),
           stop_after(DB_GEN_STOP_AFTER_SEG),
-          size_score_type(DEFAULT_DB_GEN_SIZE_SCORE_TYPE)
+          size_score_type(DEFAULT_DB_GEN_SIZE_SCORE_TYPE),
+          n_threads(1)
     {
     }
 
@@ -107,13 +116,21 @@ struct db_gen_options_t
                      )
         : silent(silent),
           stop_after(stop_after),
-          size_score_type(size_score_type)
+          size_score_type(size_score_type),
+          n_threads(1)
     {
     }
 
     bool silent;
     db_gen_stop_after_enum stop_after;
     db_gen_size_score_type size_score_type;
+
+    /*
+        Threads computing bounds and dominated moves in
+        database::generate_entries_partisan(). Doesn't change the generated
+        entries. Not stored on disk
+    */
+    size_t n_threads;
 };
 
 ////////////////////////////////////////////////// struct db_entry_partisan
@@ -220,15 +237,31 @@ inline std::ostream& operator<<(std::ostream& os,
 ////////////////////////////////////////////////// class database
 #define DB_MAP_T std::unordered_map
 
+enum db_file_format
+{
+    DB_FILE_FORMAT_STREAM = 0,
+    DB_FILE_FORMAT_INDEXED,
+};
+
 class database
 {
 public:
     database();
+    ~database();
+
+    database(database&& other);
+    database& operator=(database&& other);
 
     /*
         I/O functions
+
+        DB_FILE_FORMAT_INDEXED files (see db_indexed_file.h) are mapped by
+        load(), and their partisan entries are decoded on first lookup. Each
+        disk game type's segment is loaded on the first lookup of that type.
+        load() detects the file's format.
     */
-    void save(const std::string& filename) const;
+    void save(const std::string& filename,
+              db_file_format format = DB_FILE_FORMAT_STREAM) const;
     void load(const std::string& filename);
 
     // Human readable, one entry per line
@@ -279,6 +312,13 @@ public:
     /*
         Entry generation functions. When `silent` or `gen_opts.silent` is true,
         info is not printed to stdout.
+
+        With gen_opts.n_threads > 1, generate_entries_partisan() first
+        generates all entries up to their outcome classes, in the serial
+        order. Bounds and dominated moves are then computed on worker threads,
+        one layer of entries at a time, where each layer only depends on
+        previous layers. SEG runs last, serially in the original order. The
+        resulting database is identical to a serial build.
     */
     void generate_entries_partisan(i_db_game_generator& gen,
                                    const db_gen_options_t& gen_opts);
@@ -291,6 +331,14 @@ public:
 
     void refine_partisan_links();
 
+    /*
+        Adds existing entries of the given runtime game type to the
+        equivalence classes used by SEG (see db_make_simplest_equal_game.h),
+        so entries generated afterwards can link to them. Existing links are
+        unchanged. Used when extending a loaded database.
+    */
+    void add_existing_entries_to_equivalence_classes(game_type_t runtime_type);
+
     /*
         Misc data lookup.
     */
@@ -303,8 +351,24 @@ public:
     void clear();
     bool empty() const;
 
+    /*
+        Evicts least recently used segments of a loaded indexed file until
+        their decoded entries fit in `budget_bytes`. Segments with entries
+        linking into an evicted segment are evicted too. 0 means no limit.
+
+        Invalidates pointers to entries of evicted segments, so only call
+        this between searches, when no entry pointers are held.
+    */
+    void enforce_memory_budget(uint64_t budget_bytes);
+
     bool is_equal(const database& other) const;
 
+    /*
+        Writes the version, date and config string. If the string is already
+        set (i.e. the database was loaded and then extended), these are
+        appended on a new "Extended" line instead, so the string records
+        every config the database was built from.
+    */
     void update_metadata_string(const std::string& config_string);
 
     static hash_t get_db_hash(const game& g);
@@ -348,9 +412,16 @@ private:
 
     void _generate_single_impartial_entry(impartial_game* ig, bool silent);
 
+    void _finish_pending_partisan_entries(
+        std::vector<database_impl::pending_partisan_entry>& pending,
+        const db_gen_options_t& gen_opts);
+
     void _convert_link_single(db_link_t& link);
     void _convert_links_to_pointers();
 
+    void _save_indexed(const std::string& filename) const;
+    void _load_indexed(const std::string& filename);
+
     static game_type_t _get_sum_db_type(const sumgame& sum);
     static game_type_t _get_game_db_type(const game& g);
 
@@ -367,6 +438,32 @@ private:
     std::pair<const hash_t, db_entry_partisan>* _get_or_allocate_partisan_impl(
         const Game_Or_Sum_T& g);
 
+    // disk_type is 0 when unknown
+    std::pair<const hash_t, db_entry_partisan>* _find_partisan(
+        hash_t hash, game_type_t disk_type) const;
+
+    /*
+        Indexed file helpers. Entries decoded from the indexed file are moved
+        into _terminal_partisan, and their links converted to pointers,
+        decoding linked entries too. Call with _indexed_mutex locked.
+
+        With exact_type, only disk_type's segment is searched. Otherwise it's
+        searched first, then loaded segments, then the rest
+    */
+    std::pair<const hash_t, db_entry_partisan>* _find_or_decode_locked(
+        hash_t hash, game_type_t disk_type, bool exact_type) const;
+
+    std::pair<const hash_t, db_entry_partisan>* _decode_record_locked(
+        size_t segment_idx, size_t record_idx) const;
+
+    void _touch_segment_locked(game_type_t disk_type) const;
+    void _evict_segment_locked(size_t segment_idx);
+
+    // Decodes all remaining entries, then closes the indexed file
+    void _decode_all_indexed() const;
+
+    size_t _n_partisan_entries() const;
+
     /*
         "Runtime-only" data that isn't stored on disk.
     */
@@ -374,6 +471,26 @@ private:
     mutable std::unique_ptr<global_hash> _global_hash;
     uint64_t _n_entries_generated;
 
+    /*
+        Not nullptr during parallel generation. Entries are then generated
+        up to their outcome class, and finished later in this order
+    */
+    std::vector<database_impl::pending_partisan_entry>* _pending_partisan;
+
+    /*
+        Not nullptr after loading an indexed file, until all of its entries
+        are decoded. Lookups then lock _indexed_mutex, as they may insert
+        into _terminal_partisan
+    */
+    mutable std::unique_ptr<db_indexed_file> _indexed_file;
+    std::unique_ptr<std::mutex> _indexed_mutex;
+    mutable uint64_t _n_indexed_decoded;
+
+    // One per segment of _indexed_file
+    mutable std::vector<database_impl::indexed_segment_state>
+        _indexed_segments;
+    mutable uint64_t _indexed_use_counter;
+
     /*
         Data stored on disk.
     */
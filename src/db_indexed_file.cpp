@@ -0,0 +1,666 @@
+#include "db_indexed_file.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "byte_order.h"
+#include "database.h"
+#include "db_entry_serializers.h" // IWYU pragma: keep
+#include "hashing.h"
+#include "iobuffer.h"
+#include "mapped_file.h"
+#include "serializer.h"
+#include "thermograph_cache.h"
+#include "throw_assert.h"
+#include "type_table.h"
+#include "utilities.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// helpers
+namespace {
+constexpr char DB_INDEXED_MAGIC[8] = {'M', 'C', 'G', 'S', 'D', 'B', 'I', 'X'};
+constexpr uint64_t DB_INDEXED_VERSION = 2;
+
+// Magic, then 5 u64 fields
+constexpr size_t DB_INDEXED_HEADER_BYTES = sizeof(DB_INDEXED_MAGIC) + 5 * 8;
+
+// Disk type, record count, offset, size
+constexpr size_t DB_INDEXED_TABLE_ENTRY_BYTES = 4 * 8;
+
+// 8 u64 fields
+constexpr size_t DB_INDEXED_SEGMENT_HEADER_BYTES = 8 * 8;
+
+constexpr size_t DB_INDEXED_MAX_BUCKET_BITS = 32;
+
+typedef const pair<const hash_t, db_entry_partisan>* entry_ptr_t;
+
+inline size_t align_8(size_t offset)
+{
+    return (offset + 7) & ~size_t(7);
+}
+
+// About 4 records per bucket
+size_t choose_bucket_bits(size_t n_records)
+{
+    size_t bits = 0;
+    while (bits < DB_INDEXED_MAX_BUCKET_BITS && (size_t(4) << bits) < n_records)
+        bits++;
+
+    return bits;
+}
+
+inline size_t get_bucket(hash_t hash, size_t bucket_bits)
+{
+    if (bucket_bits == 0)
+        return 0;
+
+    return static_cast<size_t>(hash >> (size_in_bits<hash_t>() - bucket_bits));
+}
+
+void write_padding(i_obuffer& os, size_t& offset, size_t target_offset)
+{
+    assert(offset <= target_offset);
+
+    while (offset < target_offset)
+    {
+        os.write_u8(0);
+        offset++;
+    }
+}
+
+vector<uint8_t> encode_arena_fields(const db_entry_partisan& entry)
+{
+    memory_obuffer os;
+    serializer_ctx ctx;
+
+#ifdef DB_INCLUDE_STRINGS
+    serializer_save(os, entry.sum_string, &ctx);
+#endif
+    serializer_save(os, entry.bounds_data, &ctx);
+    serializer_save(os, entry.dominated_moves, &ctx);
+    serializer_save(os, entry.serialized_sum, &ctx);
+    serializer_save(os, entry.subgame_links, &ctx);
+
+    return os.release_data();
+}
+
+hash_t get_link_hash(const db_link_t& link)
+{
+    const pair<const hash_t, db_entry_partisan>* ptr = link.get_as_pointer();
+    return (ptr == nullptr) ? 0 : ptr->first;
+}
+
+// Entries in [begin, end) are sorted by hash, and have the same disk type
+vector<uint8_t> encode_segment(const entry_ptr_t* begin, const entry_ptr_t* end,
+                               const thermograph_cache& graph_cache)
+{
+    assert(begin < end);
+
+    const size_t n_records = static_cast<size_t>(end - begin);
+    const size_t bucket_bits = choose_bucket_bits(n_records);
+    const size_t n_buckets = size_t(1) << bucket_bits;
+
+    // Arena and bucket index
+    vector<uint8_t> arena;
+    vector<pair<uint64_t, uint64_t>> arena_ranges;
+    arena_ranges.reserve(n_records);
+
+    vector<uint64_t> bucket_index(n_buckets + 1, 0);
+
+    for (size_t i = 0; i < n_records; i++)
+    {
+        const hash_t hash = begin[i]->first;
+
+        const vector<uint8_t> fields = encode_arena_fields(begin[i]->second);
+        arena_ranges.emplace_back(arena.size(), fields.size());
+        arena.insert(arena.end(), fields.begin(), fields.end());
+
+        bucket_index[get_bucket(hash, bucket_bits) + 1]++;
+    }
+
+    for (size_t i = 0; i < n_buckets; i++)
+        bucket_index[i + 1] += bucket_index[i];
+
+    // Layout, relative to the segment
+    const size_t index_offset = DB_INDEXED_SEGMENT_HEADER_BYTES;
+    const size_t hashes_offset = index_offset + 8 * (n_buckets + 1);
+    const size_t records_offset = hashes_offset + 8 * n_records;
+    const size_t arena_offset =
+        align_8(records_offset + DB_INDEXED_RECORD_BYTES * n_records);
+
+    memory_obuffer os;
+    size_t offset = 0;
+
+    // Segment header
+    os.write_u64(begin[0]->second.disk_game_type);
+    os.write_u64(n_records);
+    os.write_u64(bucket_bits);
+    os.write_u64(index_offset);
+    os.write_u64(hashes_offset);
+    os.write_u64(records_offset);
+    os.write_u64(arena_offset);
+    os.write_u64(arena.size());
+    offset += DB_INDEXED_SEGMENT_HEADER_BYTES;
+
+    // Index
+    for (const uint64_t record_idx : bucket_index)
+        os.write_u64(record_idx);
+
+    // Hashes
+    for (const entry_ptr_t* it = begin; it != end; it++)
+        os.write_u64((*it)->first);
+
+    // Records
+    for (size_t i = 0; i < n_records; i++)
+    {
+        const db_entry_partisan& entry = begin[i]->second;
+
+        os.write_u32(entry.disk_game_type);
+        os.write_enum(entry.outcome);
+        os.write_enum(entry.size_score_type);
+        os.write_u16(0);
+        os.write_u64(entry.complexity);
+        os.write_u64(entry.size_score);
+        os.write_u64(graph_cache.get_graph_id(entry.thermograph.get()));
+        os.write_u64(get_link_hash(entry.simplest_equal_entry));
+        os.write_u64(arena_ranges[i].first);
+        os.write_u64(arena_ranges[i].second);
+    }
+
+    offset = records_offset + DB_INDEXED_RECORD_BYTES * n_records;
+
+    // Arena
+    write_padding(os, offset, arena_offset);
+    for (const uint8_t byte : arena)
+        os.write_u8(byte);
+
+    return os.release_data();
+}
+
+} // namespace
+
+////////////////////////////////////////////////// db_indexed_file methods
+db_indexed_file::db_indexed_file(const string& file_name)
+    : _file_name(file_name),
+      _data(nullptr),
+      _size(0),
+      _prefix_offset(0),
+      _prefix_size(0)
+{
+    const string error_prefix = "Indexed DB file \"" + file_name + "\" ";
+
+    if (mapped_file::SUPPORTED)
+    {
+        _mapping.reset(new mapped_file(file_name, MAPPED_FILE_READ_ONLY));
+        _data = _mapping->data();
+        _size = _mapping->size();
+    }
+    else
+    {
+        // Only the header here; the rest of the front is read below
+        ifstream fs(file_name, ios::binary | ios::ate);
+        THROW_ASSERT(fs.is_open(), "Failed to open file \"" + file_name + "\"!");
+        _size = static_cast<size_t>(fs.tellg());
+
+        THROW_ASSERT(_size >= DB_INDEXED_HEADER_BYTES,
+                     error_prefix + "has no valid header!");
+
+        _owned_data = _read_file_range(0, DB_INDEXED_HEADER_BYTES);
+        _data = _owned_data.data();
+    }
+
+    THROW_ASSERT(_size >= DB_INDEXED_HEADER_BYTES &&
+                     memcmp(_data, DB_INDEXED_MAGIC, sizeof(DB_INDEXED_MAGIC)) ==
+                         0,
+                 error_prefix + "has no valid header!");
+
+    range_ibuffer is(_data + sizeof(DB_INDEXED_MAGIC),
+                     DB_INDEXED_HEADER_BYTES - sizeof(DB_INDEXED_MAGIC));
+
+    const uint64_t version = is.read_u64();
+    THROW_ASSERT(version == DB_INDEXED_VERSION,
+                 error_prefix + "has unsupported version!");
+
+    const uint64_t n_segments = is.read_u64();
+    _prefix_offset = is.read_u64();
+    _prefix_size = is.read_u64();
+    const uint64_t table_offset = is.read_u64();
+
+    const bool valid_front =
+        (_prefix_offset >= DB_INDEXED_HEADER_BYTES) &&
+        (_prefix_offset <= _size) &&
+        (_prefix_size <= _size - _prefix_offset) &&
+        (table_offset >= _prefix_offset + _prefix_size) &&
+        (table_offset <= _size) &&
+        (n_segments <= (_size - table_offset) / DB_INDEXED_TABLE_ENTRY_BYTES);
+
+    THROW_ASSERT(valid_front, error_prefix + "has invalid layout!");
+
+    const size_t table_end =
+        table_offset + DB_INDEXED_TABLE_ENTRY_BYTES * n_segments;
+
+    if (!mapped_file::SUPPORTED)
+    {
+        _owned_data = _read_file_range(0, table_end);
+        _data = _owned_data.data();
+    }
+
+    // Segment table
+    range_ibuffer table_is(_data + table_offset,
+                           DB_INDEXED_TABLE_ENTRY_BYTES * n_segments);
+
+    _segments.resize(n_segments);
+
+    for (size_t i = 0; i < n_segments; i++)
+    {
+        segment_t& segment = _segments[i];
+
+        const uint64_t disk_type = table_is.read_u64();
+        const bool duplicate =
+            find_segment(static_cast<game_type_t>(disk_type)).has_value();
+
+        segment.n_records = table_is.read_u64();
+        segment.offset = table_is.read_u64();
+        segment.size = table_is.read_u64();
+
+        segment.disk_type = static_cast<game_type_t>(disk_type);
+        segment.loaded = false;
+        segment.data = nullptr;
+        segment.bucket_bits = 0;
+        segment.index_offset = 0;
+        segment.hashes_offset = 0;
+        segment.records_offset = 0;
+        segment.arena_offset = 0;
+        segment.arena_size = 0;
+
+        const bool valid_segment =
+            (disk_type != 0) && (disk_type == segment.disk_type) &&
+            !duplicate &&
+            (segment.offset >= table_end) && (segment.offset % 8 == 0) &&
+            (segment.offset <= _size) &&
+            (segment.size <= _size - segment.offset) &&
+            (segment.size >= DB_INDEXED_SEGMENT_HEADER_BYTES) &&
+            (segment.n_records <= segment.size / DB_INDEXED_RECORD_BYTES);
+
+        THROW_ASSERT(valid_segment, error_prefix + "has invalid segment table!");
+    }
+}
+
+bool db_indexed_file::is_indexed_file(const string& file_name)
+{
+    ifstream fs(file_name, ios::binary);
+    if (!fs.is_open())
+        return false;
+
+    char magic[sizeof(DB_INDEXED_MAGIC)];
+    fs.read(magic, sizeof(magic));
+
+    return fs.good() && memcmp(magic, DB_INDEXED_MAGIC, sizeof(magic)) == 0;
+}
+
+void db_indexed_file::write(const string& file_name,
+                            const vector<uint8_t>& prefix,
+                            vector<entry_ptr_t> entries,
+                            const thermograph_cache& graph_cache)
+{
+    // Group by disk type, then sort by hash
+    sort(entries.begin(), entries.end(),
+         [](entry_ptr_t entry1, entry_ptr_t entry2)
+         {
+             const game_type_t type1 = entry1->second.disk_game_type;
+             const game_type_t type2 = entry2->second.disk_game_type;
+
+             if (type1 != type2)
+                 return type1 < type2;
+
+             return entry1->first < entry2->first;
+         });
+
+    vector<vector<uint8_t>> segments;
+
+    size_t group_begin = 0;
+    while (group_begin < entries.size())
+    {
+        const game_type_t disk_type = entries[group_begin]->second.disk_game_type;
+        THROW_ASSERT(disk_type != 0);
+
+        size_t group_end = group_begin;
+        while (group_end < entries.size() &&
+               entries[group_end]->second.disk_game_type == disk_type)
+        {
+            THROW_ASSERT(entries[group_end]->first != 0);
+            group_end++;
+        }
+
+        segments.emplace_back(encode_segment(entries.data() + group_begin,
+                                             entries.data() + group_end,
+                                             graph_cache));
+        group_begin = group_end;
+    }
+
+    // Hashes are distinct across segments too
+    {
+        vector<hash_t> hashes;
+        hashes.reserve(entries.size());
+
+        for (entry_ptr_t entry_pair : entries)
+            hashes.push_back(entry_pair->first);
+
+        sort(hashes.begin(), hashes.end());
+        THROW_ASSERT(adjacent_find(hashes.begin(), hashes.end()) ==
+                     hashes.end());
+    }
+
+    // Layout
+    const size_t prefix_offset = align_8(DB_INDEXED_HEADER_BYTES);
+    const size_t table_offset = align_8(prefix_offset + prefix.size());
+    const size_t table_end =
+        table_offset + DB_INDEXED_TABLE_ENTRY_BYTES * segments.size();
+
+    vector<size_t> segment_offsets;
+    segment_offsets.reserve(segments.size());
+
+    size_t next_segment_offset = align_8(table_end);
+    for (const vector<uint8_t>& segment : segments)
+    {
+        segment_offsets.push_back(next_segment_offset);
+        next_segment_offset = align_8(next_segment_offset + segment.size());
+    }
+
+    file_obuffer os(file_name);
+    size_t offset = 0;
+
+    // Header
+    for (const char c : DB_INDEXED_MAGIC)
+        os.write_u8(static_cast<uint8_t>(c));
+
+    os.write_u64(DB_INDEXED_VERSION);
+    os.write_u64(segments.size());
+    os.write_u64(prefix_offset);
+    os.write_u64(prefix.size());
+    os.write_u64(table_offset);
+    offset += DB_INDEXED_HEADER_BYTES;
+
+    // Prefix
+    write_padding(os, offset, prefix_offset);
+    for (const uint8_t byte : prefix)
+        os.write_u8(byte);
+    offset += prefix.size();
+
+    // Segment table. Segments start with their disk type and record count
+    write_padding(os, offset, table_offset);
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        range_ibuffer segment_is(segments[i].data(), 2 * 8);
+
+        os.write_u64(segment_is.read_u64());
+        os.write_u64(segment_is.read_u64());
+        os.write_u64(segment_offsets[i]);
+        os.write_u64(segments[i].size());
+    }
+    offset = table_end;
+
+    // Segments
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        write_padding(os, offset, segment_offsets[i]);
+        for (const uint8_t byte : segments[i])
+            os.write_u8(byte);
+        offset += segments[i].size();
+    }
+
+    os.close();
+}
+
+optional<size_t> db_indexed_file::find_segment(game_type_t disk_type) const
+{
+    const size_t n_segments = _segments.size();
+
+    for (size_t i = 0; i < n_segments; i++)
+        if (_segments[i].disk_type == disk_type)
+            return i;
+
+    return {};
+}
+
+void db_indexed_file::load_segment(size_t segment_idx)
+{
+    assert(segment_idx < _segments.size());
+    segment_t& segment = _segments[segment_idx];
+
+    if (segment.loaded)
+        return;
+
+    vector<uint8_t> owned_data;
+    const uint8_t* data = nullptr;
+
+    if (_mapping.get() != nullptr)
+        data = _data + segment.offset;
+    else
+    {
+        owned_data = _read_file_range(segment.offset, segment.size);
+        data = owned_data.data();
+    }
+
+    range_ibuffer is(data, DB_INDEXED_SEGMENT_HEADER_BYTES);
+
+    const uint64_t disk_type = is.read_u64();
+    const uint64_t n_records = is.read_u64();
+    const uint64_t bucket_bits = is.read_u64();
+    const uint64_t index_offset = is.read_u64();
+    const uint64_t hashes_offset = is.read_u64();
+    const uint64_t records_offset = is.read_u64();
+    const uint64_t arena_offset = is.read_u64();
+    const uint64_t arena_size = is.read_u64();
+
+    // Sections are in order, and fit in the segment
+    const size_t size = segment.size;
+
+    const bool valid_layout =
+        (disk_type == segment.disk_type) &&
+        (n_records == segment.n_records) &&
+        (bucket_bits <= DB_INDEXED_MAX_BUCKET_BITS) &&
+        (index_offset >= DB_INDEXED_SEGMENT_HEADER_BYTES) &&
+        (index_offset <= size) &&
+        (((size_t(1) << bucket_bits) + 1) <= (size - index_offset) / 8) &&
+        (hashes_offset >=
+         index_offset + 8 * ((size_t(1) << bucket_bits) + 1)) &&
+        (hashes_offset <= size) &&
+        (n_records <= (size - hashes_offset) / 8) &&
+        (records_offset >= hashes_offset + 8 * n_records) &&
+        (records_offset <= size) &&
+        (n_records <= (size - records_offset) / DB_INDEXED_RECORD_BYTES) &&
+        (arena_offset >= records_offset + DB_INDEXED_RECORD_BYTES * n_records) &&
+        (arena_offset <= size) && (arena_size <= size - arena_offset);
+
+    THROW_ASSERT(valid_layout, "Indexed DB file \"" + _file_name +
+                                   "\" has invalid segment layout!");
+
+    segment.owned_data = std::move(owned_data);
+    segment.data = (_mapping.get() != nullptr) ? data
+                                               : segment.owned_data.data();
+
+    segment.bucket_bits = bucket_bits;
+    segment.index_offset = index_offset;
+    segment.hashes_offset = hashes_offset;
+    segment.records_offset = records_offset;
+    segment.arena_offset = arena_offset;
+    segment.arena_size = arena_size;
+
+    segment.loaded = true;
+
+    const bool valid_index =
+        (_index_at(segment, 0) == 0) &&
+        (_index_at(segment, size_t(1) << bucket_bits) == n_records);
+
+    if (!valid_index)
+        unload_segment(segment_idx);
+
+    THROW_ASSERT(valid_index, "Indexed DB file \"" + _file_name +
+                                  "\" has invalid segment index!");
+}
+
+void db_indexed_file::unload_segment(size_t segment_idx)
+{
+    assert(segment_idx < _segments.size());
+    segment_t& segment = _segments[segment_idx];
+
+    vector<uint8_t>().swap(segment.owned_data);
+    segment.data = nullptr;
+    segment.loaded = false;
+}
+
+hash_t db_indexed_file::record_hash(size_t segment_idx, size_t record_idx) const
+{
+    const segment_t& segment = _get_loaded_segment(segment_idx);
+    assert(record_idx < segment.n_records);
+
+    return _read_u64(segment.data, segment.hashes_offset + 8 * record_idx);
+}
+
+optional<size_t> db_indexed_file::find(size_t segment_idx, hash_t hash) const
+{
+    const segment_t& segment = _get_loaded_segment(segment_idx);
+    const size_t bucket = get_bucket(hash, segment.bucket_bits);
+
+    size_t low = _index_at(segment, bucket);
+    size_t high = _index_at(segment, bucket + 1);
+
+    // Binary search [low, high)
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        const hash_t mid_hash = record_hash(segment_idx, mid);
+
+        if (mid_hash == hash)
+            return mid;
+
+        if (mid_hash < hash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return {};
+}
+
+size_t db_indexed_file::record_arena_size(size_t segment_idx,
+                                         size_t record_idx) const
+{
+    const segment_t& segment = _get_loaded_segment(segment_idx);
+
+    // Last field of the record
+    return _read_u64(_record_data(segment, record_idx),
+                     DB_INDEXED_RECORD_BYTES - 8);
+}
+
+db_entry_partisan db_indexed_file::decode_record(
+    size_t segment_idx, size_t record_idx, thermograph_cache& graph_cache) const
+{
+    const segment_t& segment = _get_loaded_segment(segment_idx);
+
+    db_entry_partisan entry;
+
+    range_ibuffer record_is(_record_data(segment, record_idx),
+                            DB_INDEXED_RECORD_BYTES);
+
+    entry.disk_game_type = record_is.read_u32();
+    entry.outcome = record_is.read_enum<outcome_class>();
+    entry.size_score_type = record_is.read_enum<db_gen_size_score_type>();
+    record_is.read_u16();
+    entry.complexity = record_is.read_u64();
+    entry.size_score = record_is.read_u64();
+    entry.thermograph = graph_cache.get_graph_from_id(record_is.read_u64());
+    entry.simplest_equal_entry.set_as_hash(record_is.read_u64());
+
+    const uint64_t arena_begin = record_is.read_u64();
+    const uint64_t arena_size = record_is.read_u64();
+
+    THROW_ASSERT(entry.disk_game_type == segment.disk_type,
+                 "Indexed DB record is in the wrong segment!");
+
+    THROW_ASSERT(arena_begin <= segment.arena_size &&
+                     arena_size <= segment.arena_size - arena_begin,
+                 "Indexed DB record has invalid arena range!");
+
+    range_ibuffer is(segment.data + segment.arena_offset + arena_begin,
+                     arena_size);
+    serializer_ctx ctx;
+
+#ifdef DB_INCLUDE_STRINGS
+    serializer_load(is, entry.sum_string, &ctx);
+#endif
+    serializer_load(is, entry.bounds_data, &ctx);
+    serializer_load(is, entry.dominated_moves, &ctx);
+    serializer_load(is, entry.serialized_sum, &ctx);
+    serializer_load(is, entry.subgame_links, &ctx);
+
+    THROW_ASSERT(is.bytes_read() == arena_size,
+                 "Indexed DB record has invalid arena fields!");
+
+    return entry;
+}
+
+uint64_t db_indexed_file::_read_u64(const uint8_t* data, size_t offset)
+{
+    uint64_t val;
+    memcpy(&val, data + offset, sizeof(val));
+    return disk_to_host_u64(val);
+}
+
+const db_indexed_file::segment_t& db_indexed_file::_get_loaded_segment(
+    size_t segment_idx) const
+{
+    assert(segment_idx < _segments.size());
+    const segment_t& segment = _segments[segment_idx];
+
+    assert(segment.loaded);
+    return segment;
+}
+
+uint64_t db_indexed_file::_index_at(const segment_t& segment,
+                                    size_t bucket) const
+{
+    assert(bucket <= (size_t(1) << segment.bucket_bits));
+
+    const uint64_t record_idx =
+        _read_u64(segment.data, segment.index_offset + 8 * bucket);
+    THROW_ASSERT(record_idx <= segment.n_records,
+                 "Indexed DB has invalid index!");
+
+    return record_idx;
+}
+
+const uint8_t* db_indexed_file::_record_data(const segment_t& segment,
+                                             size_t record_idx) const
+{
+    assert(record_idx < segment.n_records);
+    return segment.data + segment.records_offset +
+           DB_INDEXED_RECORD_BYTES * record_idx;
+}
+
+vector<uint8_t> db_indexed_file::_read_file_range(size_t offset,
+                                                  size_t size) const
+{
+    ifstream fs(_file_name, ios::binary);
+    THROW_ASSERT(fs.is_open(), "Failed to open file \"" + _file_name + "\"!");
+
+    vector<uint8_t> data(size);
+
+    fs.seekg(static_cast<streamoff>(offset));
+    fs.read(reinterpret_cast<char*>(data.data()),
+            static_cast<streamsize>(size));
+    THROW_ASSERT(fs.good(), "Failed to read file \"" + _file_name + "\"!");
+
+    return data;
+}
@@ -0,0 +1,198 @@
+/*
+    Indexed database file format. Partisan entries are grouped into one
+    segment per disk game type. Within a segment, entries are fixed width
+    records sorted by DB hash, so segments can be mapped (see mapped_file.h)
+    or read individually, and entries found and decoded on demand instead of
+    loading the whole database:
+
+        [header]
+        [prefix: metadata, type mapper, thermograph cache, max size scores,
+            impartial entries, encoded as by database::save()]
+        [segment table: disk game type, record count, offset and size of
+            each segment]
+        [segments...]
+
+    Each segment is:
+
+        [segment header]
+        [bucket index: (1 << bucket_bits) + 1 record indices]
+        [hashes: sorted DB hash of each record]
+        [records: DB_INDEXED_RECORD_BYTES each]
+        [arena: variable size fields of the records]
+
+    Sections start at multiples of 8 bytes, and segment section offsets are
+    relative to the segment. Integers are stored in disk byte order (see
+    byte_order.h), so files are portable across machines.
+
+    Bucket i holds the records whose hashes have i as their top bucket_bits
+    bits. Lookups binary search one bucket.
+
+    Records hold the fixed size fields of db_entry_partisan, and the
+    thermograph ID and simplest equal entry hash. Bounds, dominated moves,
+    the serialized sum and subgame links are in the record's arena range.
+
+    A segment must be loaded before its records are used. Loading parses the
+    segment's header, and reads the segment's bytes if the file isn't mapped.
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "database.h"
+#include "hashing.h"
+#include "mapped_file.h"
+#include "thermograph_cache.h"
+
+inline constexpr size_t DB_INDEXED_RECORD_BYTES = 56;
+
+////////////////////////////////////////////////// class db_indexed_file
+class db_indexed_file
+{
+public:
+    /*
+        Maps the file, or reads its prefix and segment table where mapping
+        isn't supported. Throws if the file isn't a valid indexed DB file
+    */
+    db_indexed_file(const std::string& file_name);
+
+    // no copy
+    db_indexed_file(const db_indexed_file& rhs) = delete;
+    db_indexed_file& operator=(const db_indexed_file& rhs) = delete;
+
+    // True if the file starts with the indexed format's magic bytes
+    static bool is_indexed_file(const std::string& file_name);
+
+    /*
+        Entries must have distinct, non-0 hashes. Their thermographs must be
+        in `graph_cache`
+    */
+    static void write(
+        const std::string& file_name, const std::vector<uint8_t>& prefix,
+        std::vector<const std::pair<const hash_t, db_entry_partisan>*> entries,
+        const thermograph_cache& graph_cache);
+
+    const uint8_t* prefix_data() const;
+    size_t prefix_size() const;
+
+    /*
+        Segment functions
+    */
+    size_t n_segments() const;
+    std::optional<size_t> find_segment(game_type_t disk_type) const;
+
+    game_type_t segment_disk_type(size_t segment_idx) const;
+    size_t segment_n_records(size_t segment_idx) const;
+
+    // Bytes held in memory while loaded; 0 for mapped files
+    size_t segment_n_owned_bytes(size_t segment_idx) const;
+
+    bool is_segment_loaded(size_t segment_idx) const;
+
+    // Throws if the segment is invalid
+    void load_segment(size_t segment_idx);
+    void unload_segment(size_t segment_idx);
+
+    /*
+        Record functions. The segment must be loaded
+    */
+    hash_t record_hash(size_t segment_idx, size_t record_idx) const;
+
+    std::optional<size_t> find(size_t segment_idx, hash_t hash) const;
+
+    // Size of the record's variable size fields
+    size_t record_arena_size(size_t segment_idx, size_t record_idx) const;
+
+    // Links of the entry are hashes (see db_link_t)
+    db_entry_partisan decode_record(size_t segment_idx, size_t record_idx,
+                                    thermograph_cache& graph_cache) const;
+
+private:
+    struct segment_t
+    {
+        game_type_t disk_type;
+        size_t offset;
+        size_t size;
+
+        bool loaded;
+        std::vector<uint8_t> owned_data;
+        const uint8_t* data;
+
+        size_t n_records;
+        size_t bucket_bits;
+
+        size_t index_offset;
+        size_t hashes_offset;
+        size_t records_offset;
+        size_t arena_offset;
+        size_t arena_size;
+    };
+
+    std::string _file_name;
+
+    std::unique_ptr<mapped_file> _mapping;
+    std::vector<uint8_t> _owned_data;
+
+    const uint8_t* _data;
+    size_t _size;
+
+    size_t _prefix_offset;
+    size_t _prefix_size;
+
+    std::vector<segment_t> _segments;
+
+    static uint64_t _read_u64(const uint8_t* data, size_t offset);
+
+    const segment_t& _get_loaded_segment(size_t segment_idx) const;
+    uint64_t _index_at(const segment_t& segment, size_t bucket) const;
+    const uint8_t* _record_data(const segment_t& segment,
+                                size_t record_idx) const;
+
+    std::vector<uint8_t> _read_file_range(size_t offset, size_t size) const;
+};
+
+////////////////////////////////////////////////// db_indexed_file methods
+inline const uint8_t* db_indexed_file::prefix_data() const
+{
+    return _data + _prefix_offset;
+}
+
+inline size_t db_indexed_file::prefix_size() const
+{
+    return _prefix_size;
+}
+
+inline size_t db_indexed_file::n_segments() const
+{
+    return _segments.size();
+}
+
+inline game_type_t db_indexed_file::segment_disk_type(size_t segment_idx) const
+{
+    assert(segment_idx < _segments.size());
+    return _segments[segment_idx].disk_type;
+}
+
+inline size_t db_indexed_file::segment_n_records(size_t segment_idx) const
+{
+    assert(segment_idx < _segments.size());
+    return _segments[segment_idx].n_records;
+}
+
+inline size_t db_indexed_file::segment_n_owned_bytes(size_t segment_idx) const
+{
+    assert(segment_idx < _segments.size());
+    return _segments[segment_idx].owned_data.size();
+}
+
+inline bool db_indexed_file::is_segment_loaded(size_t segment_idx) const
+{
+    assert(segment_idx < _segments.size());
+    return _segments[segment_idx].loaded;
+}
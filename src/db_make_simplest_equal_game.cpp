@@ -614,6 +614,64 @@ void db_refine_simplest_equal_game(
     }
 }
 
+void db_add_existing_entry_to_equivalence_class(
+    pair<const hash_t, db_entry_partisan>& entry_pair, database& db)
+{
+    const hash_t hash = entry_pair.first;
+    const db_entry_partisan& entry = entry_pair.second;
+
+    THROW_ASSERT(entry.size_score_type != DB_GEN_SIZE_SCORE_TYPE_NONE);
+
+    // Already added (i.e. the zero entry)
+    if (global_hash_to_seg_vec_idx.find(hash) !=
+        global_hash_to_seg_vec_idx.end())
+        return;
+
+    const seg_map_idx_t seg_map_idx = make_seg_map_index(entry);
+    vector<equivalence_class>& eq_classes = seg_map[seg_map_idx];
+
+    optional<size_t> class_idx;
+
+    // Join the class of the linked entry, if it has one
+    const pair<const hash_t, db_entry_partisan>* linked_pair =
+        entry.simplest_equal_entry.get_as_pointer();
+
+    if (linked_pair != nullptr && linked_pair != &entry_pair &&
+        make_seg_map_index(linked_pair->second) == seg_map_idx)
+    {
+        const auto idx_iterator =
+            global_hash_to_seg_vec_idx.find(linked_pair->first);
+
+        if (idx_iterator != global_hash_to_seg_vec_idx.end())
+            class_idx = idx_iterator->second;
+    }
+
+    // Otherwise search
+    if (!class_idx.has_value())
+    {
+        sumgame sum(BLACK);
+        vector<game*> games = entry.load_sum();
+
+        sum.add(games);
+        class_idx = find_sum_equivalence_class(sum, eq_classes, db);
+        sum.pop(games);
+
+        for (game* g : games)
+            delete g;
+    }
+
+    if (!class_idx.has_value())
+    {
+        eq_classes.emplace_back();
+        class_idx = eq_classes.size() - 1;
+    }
+
+    THROW_ASSERT(*class_idx < eq_classes.size());
+
+    global_hash_to_seg_vec_idx[hash] = *class_idx;
+    eq_classes[*class_idx].insert_link(db.get_partisan_link(&entry_pair), db);
+}
+
 void delete_equivalence_classes()
 {
     seg_map.clear();
@@ -16,6 +16,14 @@ void db_make_simplest_equal_game(sumgame& sum, db_entry_partisan& entry,
 void db_refine_simplest_equal_game(
     std::pair<const hash_t, db_entry_partisan>& entry_pair, database& db);
 
+/*
+    Adds an existing entry with SEG data to the equivalence classes, without
+    changing its link, so that entries generated afterwards can link to it.
+    Used when extending a loaded database
+*/
+void db_add_existing_entry_to_equivalence_class(
+    std::pair<const hash_t, db_entry_partisan>& entry_pair, database& db);
+
 void delete_equivalence_classes();
 void reinitialize_equivalence_classes(database& db);
 void assert_equivalence_classes_have_zero_entry(database& db);
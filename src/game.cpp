@@ -4,6 +4,7 @@
 #include <cassert>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <cstddef>
 #include <sstream>
@@ -20,6 +21,20 @@ using std::unique_ptr;
 
 game_type_t game::_next_game_type = 1;
 
+namespace {
+std::mutex game_type_mutex;
+} // namespace
+
+game_type_t game::_assign_game_type(game_type_t& gt)
+{
+    std::lock_guard<std::mutex> lock(game_type_mutex);
+
+    if (gt == 0)
+        gt = _next_game_type++;
+
+    return gt;
+}
+
 std::string game::to_string() const
 {
     std::stringstream str;
@@ -197,6 +197,10 @@ private:
 
     static game_type_t _next_game_type;
 
+    // Slow path of game_type(). Thread safe (types may first be seen by a
+    // parallel search worker)
+    static game_type_t _assign_game_type(game_type_t& gt);
+
     template <class T> // NOLINTNEXTLINE(readability-identifier-naming)
     friend game_type_t __game_type_impl();
 
@@ -277,7 +281,7 @@ game_type_t __game_type_impl()
     game_type_t& gt = type_table<T>()->game_type_ref();
 
     if (gt == 0) [[unlikely]]
-        gt = game::_next_game_type++;
+        return game::_assign_game_type(gt);
 
     return gt;
 }
@@ -299,7 +303,7 @@ inline game_type_t game::game_type() const
     game_type_t& gt = type_table()->game_type_ref();
 
     if (gt == 0) [[unlikely]]
-        gt = _next_game_type++;
+        return _assign_game_type(gt);
 
     return gt;
 }
@@ -94,10 +94,26 @@ optional<vector<string>> get_winning_moves_impl(
 
     bool over_time = false;
 
+    /*
+        Partisan sums are solved first. A loss has no winning moves, and a
+        win's move is usually in the ttable, so it needn't be searched again
+    */
+    bool sum_is_loss = false;
+    optional<sumgame_move> ttable_winning_move;
+
+    if (!use_impartial)
+    {
+        const optional<solve_result> result = sum.solve_with_timeout_token(
+            timeout_tok, depth, &ttable_winning_move);
+
+        over_time = !result.has_value();
+        sum_is_loss = result.has_value() && !result->win;
+    }
+
     unique_ptr<sumgame_move_generator> gen(
         sum.create_sum_move_generator(use_player));
 
-    while (*gen)
+    while (*gen && !over_time && !sum_is_loss)
     {
         over_time = timeout_tok.stop_requested();
 
@@ -105,8 +121,13 @@ optional<vector<string>> get_winning_moves_impl(
             break;
 
         sumgame_move sm = gen->gen_sum_move();
-        optional<bool> is_winning_opt =
-            is_winning_move(sum, sm, use_player, use_impartial, timeout_tok, depth);
+        optional<bool> is_winning_opt;
+
+        if (ttable_winning_move.has_value() && sm == *ttable_winning_move)
+            is_winning_opt = true;
+        else
+            is_winning_opt = is_winning_move(sum, sm, use_player,
+                                             use_impartial, timeout_tok, depth);
 
         if (!is_winning_opt.has_value())
         {
@@ -104,18 +104,19 @@ INIT_GLOBAL_WITH_SUMMARY(random_seed, uint64_t, 7753);
 INIT_GLOBAL_WITH_SUMMARY(simplify_basic_cgt, bool, true);
 
 #ifdef __EMSCRIPTEN__
-INIT_GLOBAL_WITH_SUMMARY(tt_sumgame_idx_bits, size_t, 27);     // 27 -> ~656 MiB
-INIT_GLOBAL_WITH_SUMMARY(tt_imp_sumgame_idx_bits, size_t, 26); // 26 -> ~576 MiB
+INIT_GLOBAL_WITH_SUMMARY(tt_sumgame_idx_bits, size_t, 25);     // 25 -> 512 MiB
+INIT_GLOBAL_WITH_SUMMARY(tt_imp_sumgame_idx_bits, size_t, 25); // 25 -> 512 MiB
+INIT_GLOBAL_WITH_SUMMARY(tt_dfpn_idx_bits, size_t, 22);        // 22 -> 64 MiB
 INIT_GLOBAL_WITH_SUMMARY(use_db, bool, false);
 #else
-INIT_GLOBAL_WITH_SUMMARY(tt_sumgame_idx_bits, size_t, 28);
-INIT_GLOBAL_WITH_SUMMARY(tt_imp_sumgame_idx_bits, size_t, 26);
-//INIT_GLOBAL_WITH_SUMMARY(tt_sumgame_idx_bits, size_t, 28);     // ~1312 MiB
-//INIT_GLOBAL_WITH_SUMMARY(tt_imp_sumgame_idx_bits, size_t, 27); // ~1152 MiB
+INIT_GLOBAL_WITH_SUMMARY(tt_sumgame_idx_bits, size_t, 27);     // 2 GiB
+INIT_GLOBAL_WITH_SUMMARY(tt_imp_sumgame_idx_bits, size_t, 26); // 1 GiB
+INIT_GLOBAL_WITH_SUMMARY(tt_dfpn_idx_bits, size_t, 24);        // 256 MiB
 INIT_GLOBAL_WITH_SUMMARY(use_db, bool, true);
 INIT_GLOBAL_WITH_SUMMARY(use_seg, bool, true);
 #endif
 
+INIT_GLOBAL_WITH_SUMMARY(tt_replacement, std::string, "always");
 
 INIT_GLOBAL_WITH_SUMMARY(clear_tt, bool, false);
 INIT_GLOBAL_WITH_SUMMARY(pitm, bool, true);
@@ -128,13 +129,22 @@ INIT_GLOBAL_WITH_SUMMARY(imp_wrapper_alternate_color, bool, true);
 
 INIT_GLOBAL_WITH_SUMMARY(play_normalize, bool, true);
 INIT_GLOBAL_WITH_SUMMARY(dedupe_movegen, bool, true);
+INIT_GLOBAL_WITH_SUMMARY(threads, size_t, 1);
+INIT_GLOBAL_WITH_SUMMARY(search_algorithm, std::string, "minimax");
+INIT_GLOBAL_WITH_SUMMARY(move_ordering, std::string, "killer");
+INIT_GLOBAL_WITH_SUMMARY(iterative_deepening, bool, false);
 
 // These WILL NOT be printed with ./MCGS --print-optimizations
 INIT_GLOBAL_WITHOUT_SUMMARY(silence_warnings, bool, false);
 INIT_GLOBAL_WITHOUT_SUMMARY(print_ttable_size, bool, false);
+INIT_GLOBAL_WITHOUT_SUMMARY(print_ttable_stats, bool, false);
+INIT_GLOBAL_WITHOUT_SUMMARY(tt_mmap, bool, false);
 INIT_GLOBAL_WITHOUT_SUMMARY(play_split, bool, true);
 INIT_GLOBAL_WITHOUT_SUMMARY(print_db_info, bool, false);
 INIT_GLOBAL_WITHOUT_SUMMARY(player_color, bool, true);
+INIT_GLOBAL_WITHOUT_SUMMARY(db_gen_threads, size_t, 1);
+INIT_GLOBAL_WITHOUT_SUMMARY(db_file_indexed, bool, false);
+INIT_GLOBAL_WITHOUT_SUMMARY(db_memory_budget, size_t, 0);
 
 
 } // namespace global
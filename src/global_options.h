@@ -159,6 +159,12 @@ extern global_option<uint64_t> random_seed;
 extern global_option<bool> simplify_basic_cgt;
 extern global_option<size_t> tt_sumgame_idx_bits;
 extern global_option<size_t> tt_imp_sumgame_idx_bits;
+// ttable of proof and disproof numbers, only allocated when using df-pn
+extern global_option<size_t> tt_dfpn_idx_bits;
+// Name of ttable_replacement_policy used by ttables
+extern global_option<std::string> tt_replacement;
+// Map ttable files copy-on-write when loading, instead of reading them
+extern global_option<bool> tt_mmap;
 extern global_option<bool> use_db;
 extern global_option<bool> use_seg;
 extern global_option<bool> clear_tt;
@@ -174,11 +180,30 @@ extern global_option<bool> imp_wrapper_alternate_color;
 
 extern global_option<bool> play_normalize;
 extern global_option<bool> dedupe_movegen;
+// Number of threads used by partisan search (1 means serial search)
+extern global_option<size_t> threads;
+// Name of sumgame_search_algorithm used to solve sums
+extern global_option<std::string> search_algorithm;
+// Move ordering heuristics of minimax search (see sumgame_move_ordering.h)
+extern global_option<std::string> move_ordering;
+// Solve partisan test cases by iterative deepening (see
+// sumgame_iterative_deepening.h)
+extern global_option<bool> iterative_deepening;
 
 extern global_option<bool> silence_warnings;
 extern global_option<bool> print_ttable_size;
+extern global_option<bool> print_ttable_stats;
 extern global_option<bool> play_split;
 extern global_option<bool> print_db_info;
 extern global_option<bool> player_color;
+// Number of threads used by DB generation. Doesn't change the DB file
+extern global_option<size_t> db_gen_threads;
+// Created DB files use the indexed format (see db_indexed_file.h)
+extern global_option<bool> db_file_indexed;
+/*
+    MiB of decoded entries from a loaded indexed DB file to keep between
+    test cases (see database::enforce_memory_budget()). 0 means no limit
+*/
+extern global_option<size_t> db_memory_budget;
 
 } // namespace global
@@ -8,6 +8,7 @@
 #include <limits>
 #include <type_traits>
 #include <memory>
+#include <atomic>
 #include <vector>
 #include <random>
 #include <cstddef>
@@ -21,6 +22,8 @@ using namespace std;
 std::uniform_int_distribution<unsigned long long> random_table::_dist(
     1, std::numeric_limits<unsigned long long>::max());
 
+std::atomic<bool> random_table::_growth_locked(false);
+
 random_table::random_table(size_t n_positions, uint64_t seed) : _n_positions(0)
 {
     assert(seed != 0);
@@ -48,6 +51,10 @@ void random_table::_resize_to(size_t new_n_positions)
 {
     assert(new_n_positions > _n_positions);
 
+    THROW_ASSERT(!_growth_locked.load(std::memory_order_relaxed),
+                 "random_table can't grow during parallel search. Try "
+                 "running with \"--threads 1\"");
+
     auto get_number = [&]() -> hash_t
     {
         return (hash_t) _dist(_rng);
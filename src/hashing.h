@@ -10,6 +10,7 @@
 
 #include <optional>
 #include <vector>
+#include <atomic>
 #include <cstddef>
 #include <climits>
 #include <type_traits>
@@ -50,6 +51,16 @@ public:
 
     size_t current_size() const;
 
+    // Grow the table to at least n_positions
+    void reserve(size_t n_positions);
+
+    /*
+        While locked, tables must not grow because other threads may be
+        reading them (i.e. during parallel search). Growing a locked table
+        throws.
+    */
+    static void set_growth_locked(bool locked);
+
 private:
     void _init(uint64_t seed, size_t n_positions);
     void _resize_to(size_t new_n_positions);
@@ -60,6 +71,7 @@ private:
     // using hash_t for int distribution may be undefined behavior
     static_assert(sizeof(unsigned long long) >= sizeof(hash_t));
     static std::uniform_int_distribution<unsigned long long> _dist;
+    static std::atomic<bool> _growth_locked;
 
     std::mt19937_64 _rng;
     size_t _n_positions;
@@ -123,6 +135,17 @@ inline size_t random_table::current_size() const
     return _n_positions;
 }
 
+inline void random_table::reserve(size_t n_positions)
+{
+    if (n_positions > _n_positions)
+        _resize_to(n_positions);
+}
+
+inline void random_table::set_growth_locked(bool locked)
+{
+    _growth_locked.store(locked, std::memory_order_relaxed);
+}
+
 inline void random_table::_resize_if_out_of_range(size_t idx)
 {
     if (idx < _n_positions)
@@ -12,7 +12,7 @@
 #include "hashing.h"
 #include "impartial_lemoine_viennot.h"
 #include "solver_stats.h"
-#include "transposition.h"
+#include "transposition_concurrent.h"
 #include "timeout_token.h"
 
 //---------------------------------------------------------------------------
@@ -26,11 +26,13 @@ inline int search(game* subgame, impartial_tt& tt, const timeout_token& timeout_
     return g->search_impartial_game_cancellable(tt, timeout_tok, depth);
 }
 
-inline void tt_store(impartial_tt& tt, impartial_game* g, int nim_value)
+inline void tt_store(impartial_tt& tt, impartial_game* g, int nim_value,
+                     uint64_t depth, uint64_t node_count_before)
 {
     const hash_t hash = g->get_local_hash();
     auto tt_result = tt.search(hash);
     tt_result.set_entry(impartial_ttable_entry(nim_value));
+    tt_result.set_effort(depth, stats::search_nodes_since(node_count_before));
 }
 
 inline bool tt_lookup(impartial_tt& tt, impartial_game* g, int& nim_value)
@@ -59,7 +61,7 @@ int impartial_game::search_with_tt(int tt_size) const
 {
     if (global::impartial_algorithm_mex.get())
     {
-        impartial_tt tt(tt_size, 0);
+        impartial_tt tt(tt_size, 0, get_global_tt_replacement_policy());
         return search_impartial_game(tt);
     }
     else
@@ -90,6 +92,9 @@ int impartial_game::search_impartial_game_cancellable(
     if (is_solved())
         return nim_value();
 
+    // For ttable replacement policy
+    const uint64_t node_count_before = stats::get_search_node_count();
+
     stats::report_search_node(this, EMPTY, depth);
     const uint64_t next_depth = depth + 1; // for after a move is played
 
@@ -169,7 +174,7 @@ int impartial_game::search_impartial_game_cancellable(
     int result = mex(nimbers);
     if (g->num_moves_played() == 0)
         g->set_solved(result);
-    tt_store(tt, g, result);
+    tt_store(tt, g, result, depth, node_count_before);
     return result;
 }
 
@@ -15,7 +15,7 @@
 #include "integral_conversion.h"
 #include "iobuffer.h"
 #include "serializer.h"
-#include "transposition.h"
+#include "transposition_concurrent.h"
 #include "timeout_token.h"
 
 //---------------------------------------------------------------------------
@@ -49,7 +49,7 @@ struct serializer<impartial_ttable_entry>
     }
 };
 
-typedef ttable<impartial_ttable_entry> impartial_tt;
+typedef concurrent_ttable<impartial_ttable_entry> impartial_tt;
 
 //---------------------------------------------------------------------------
 class impartial_game : public game
@@ -16,7 +16,7 @@
 #include "impartial_game.h"
 #include "solver_stats.h"
 #include "timeout_token.h"
-#include "transposition.h"
+#include "transposition_concurrent.h"
 
 const int NO_DB_RESULT = -1;
 
@@ -63,11 +63,14 @@ inline hash_t combined_hash(const impartial_game* g, int nim_value)
 inline void tt_store(lv_bool_tt& tt,
                      const impartial_game* g,
                      int nim_value,
-                     bool result)
+                     bool result,
+                     uint64_t depth,
+                     uint64_t node_count_before)
 {
     const hash_t hash = combined_hash(g, nim_value);
     auto tt_result = tt.search(hash);
     tt_result.set_entry(lv_bool_entry(result));
+    tt_result.set_effort(depth, stats::search_nodes_since(node_count_before));
 }
 
 inline bool tt_lookup(lv_bool_tt& tt,
@@ -91,14 +94,15 @@ inline bool tt_lookup(lv_bool_tt& tt,
 // to prove that g + *n  = *i + *n != *0 is a win
 // It is very likely more efficient to store nimbers as well, 
 // in a second hash table. Especially for games equal to large nimbers.
-bool pre_search_probe(const impartial_game& g, int n, lv_bool_tt& tt)
+bool pre_search_probe(const impartial_game& g, int n, lv_bool_tt& tt,
+                      uint64_t depth, uint64_t node_count_before)
 {
     for (int i = 0; i < n; ++i)
     {
         bool result;
         if (tt_lookup(tt, &g, i, result) && !result)
         {
-            tt_store(tt, &g, n, true);
+            tt_store(tt, &g, n, true, depth, node_count_before);
             return true;
         }
     }
@@ -161,7 +165,7 @@ int search_with_tt(const impartial_game& g, int tt_size)
     timeout_token timeout_tok = src.get_timeout_token();
     src.start_timeout(0);
 
-    lv_bool_tt tt(tt_size, 0);
+    lv_bool_tt tt(tt_size, 0, get_global_tt_replacement_policy());
     const int result = search_impartial_game(g, tt, timeout_tok, INITIAL_SEARCH_DEPTH);
 
     assert(!timeout_tok.stop_requested());
@@ -191,6 +195,9 @@ int search_impartial_game(const impartial_game& g, lv_bool_tt& tt, const timeout
 bool search_g_plus_nimber(const impartial_game& g, int n,
                           lv_bool_tt& tt, const timeout_token& timeout_tok, uint64_t depth)
 {
+    // For ttable replacement policy
+    const uint64_t node_count_before = stats::get_search_node_count();
+
     {
         std::optional<hash_t> node_hash;
         if (global::count_sums())
@@ -206,7 +213,7 @@ bool search_g_plus_nimber(const impartial_game& g, int n,
     const int db_result = db_lookup(g);
     if (db_result != NO_DB_RESULT)
         return db_result != n;
-    if (pre_search_probe(g, n, tt))
+    if (pre_search_probe(g, n, tt, depth, node_count_before))
         return true;
     if (timeout_tok.stop_requested())
         return false; // return value does not matter?
@@ -240,7 +247,7 @@ bool search_g_plus_nimber(const impartial_game& g, int n,
             if (! move_result)
             {
                 g_nonconst->undo_move();
-                tt_store(tt, g_nonconst, n, true);
+                tt_store(tt, g_nonconst, n, true, depth, node_count_before);
                 return true;
             }
         }
@@ -260,7 +267,7 @@ bool search_g_plus_nimber(const impartial_game& g, int n,
             if (!move_result)
             {
                 g_nonconst->undo_move();
-                tt_store(tt, g_nonconst, n, true);
+                tt_store(tt, g_nonconst, n, true, depth, node_count_before);
                 return true;
             }
         }
@@ -278,13 +285,13 @@ bool search_g_plus_nimber(const impartial_game& g, int n,
 
         if (! move_result)
         {
-            tt_store(tt, &g, n, true);
+            tt_store(tt, &g, n, true, depth, node_count_before);
             return true;
         }
     }
 
     // Final result when g + *n is a loss - store and return
-    tt_store(tt, &g, n, false);
+    tt_store(tt, &g, n, false, depth, node_count_before);
     return false;
 }
 
@@ -11,7 +11,7 @@
 #include "iobuffer.h"
 #include "serializer.h"
 #include "throw_assert.h"
-#include "transposition.h"
+#include "transposition_concurrent.h"
 #include "impartial_game.h"
 #include "timeout_token.h"
 #include "integral_conversion.h"
@@ -32,7 +32,7 @@ struct lv_bool_entry
     lv_bool_entry(bool v) : value(v) {}
 };
 
-typedef ttable<lv_bool_entry> lv_bool_tt;
+typedef concurrent_ttable<lv_bool_entry> lv_bool_tt;
 
 } // namespace lemoine_viennot
 
@@ -2,7 +2,6 @@
 // Implementation of impartial sumgame search
 //---------------------------------------------------------------------------
 #include "impartial_sumgame.h"
-#include "iobuffer.h"
 #include "timeout_token.h"
 #include "utilities.h"
 
@@ -21,7 +20,7 @@
 #include "solver_stats.h"
 #include "throw_assert.h"
 #include "sumgame.h"
-#include "transposition_serializer.h"
+#include "transposition_concurrent.h"
 #include "exit_signal.h"
 
 using namespace std;
@@ -157,12 +156,14 @@ void init_impartial_sumgame_ttable(size_t idx_bits,
         if (global::impartial_algorithm_mex.get())
         {
             assert(!tt_optional.has_value());
-            tt_optional.emplace(idx_bits, 0);
+            tt_optional.emplace(idx_bits, 0,
+                                get_global_tt_replacement_policy());
         }
         else
         {
             assert(!lv_tt_optional.has_value());
-            lv_tt_optional.emplace(idx_bits, 0);
+            lv_tt_optional.emplace(idx_bits, 0,
+                                   get_global_tt_replacement_policy());
         }
     }
     else // Load from file
@@ -170,8 +171,9 @@ void init_impartial_sumgame_ttable(size_t idx_bits,
         cout << "Loading impartial ttable \"" << ttable_load_file_name
              << "\"..." << flush;
 
-        file_ibuffer is(ttable_load_file_name);
-        const bool ttable_is_mex = is.read_bool();
+        const bool ttable_is_mex =
+            read_ttable_file_header(ttable_load_file_name).kind ==
+            TT_FILE_IMPARTIAL_MEX;
 
         if (ttable_is_mex != global::impartial_algorithm_mex()) [[unlikely]]
         {
@@ -189,13 +191,20 @@ void init_impartial_sumgame_ttable(size_t idx_bits,
 
         if (ttable_is_mex)
         {
-            tt_optional.emplace(serializer<impartial_tt>::load(is, nullptr));
+            tt_optional.emplace(impartial_tt::load_file(
+                ttable_load_file_name, TT_FILE_IMPARTIAL_MEX,
+                global::tt_mmap()));
+            tt_optional->set_replacement_policy(
+                get_global_tt_replacement_policy());
             new_idx_bits = tt_optional->n_index_bits();
         }
         else
         {
-            lv_tt_optional.emplace(
-                serializer<lemoine_viennot::lv_bool_tt>::load(is, nullptr));
+            lv_tt_optional.emplace(lemoine_viennot::lv_bool_tt::load_file(
+                ttable_load_file_name, TT_FILE_LEMOINE_VIENNOT,
+                global::tt_mmap()));
+            lv_tt_optional->set_replacement_policy(
+                get_global_tt_replacement_policy());
 
             new_idx_bits = lv_tt_optional->n_index_bits();
         }
@@ -230,29 +239,44 @@ void save_impartial_sumgame_ttable(const string& ttable_save_file_name)
     cout << "Saving impartial ttable \"" << ttable_save_file_name << "\"..."
          << flush;
 
-    file_obuffer os(ttable_save_file_name);
-
     if (global::impartial_algorithm_mex())
     {
         assert(tt_optional.has_value());
-
-        os.write_bool(true);
-        serializer<impartial_tt>::save(os, *tt_optional, nullptr);
+        tt_optional->save_file(ttable_save_file_name, TT_FILE_IMPARTIAL_MEX);
     }
     else
     {
         assert(lv_tt_optional.has_value());
-
-        os.write_bool(false);
-        serializer<lemoine_viennot::lv_bool_tt>::save(os, *lv_tt_optional,
-                                                      nullptr);
+        lv_tt_optional->save_file(ttable_save_file_name,
+                                  TT_FILE_LEMOINE_VIENNOT);
     }
 
-    os.close();
-
     cout << " OK " << endl;
 }
 
+void print_impartial_sumgame_ttable_stats(std::ostream& os)
+{
+    if (tt_optional.has_value())
+    {
+        os << "Mex ttable ("
+           << ttable_replacement_policy_to_string(
+                  tt_optional->get_replacement_policy())
+           << ") ";
+        tt_optional->get_store_counts().print(os);
+        os << endl;
+    }
+
+    if (lv_tt_optional.has_value())
+    {
+        os << "LV ttable ("
+           << ttable_replacement_policy_to_string(
+                  lv_tt_optional->get_replacement_policy())
+           << ") ";
+        lv_tt_optional->get_store_counts().print(os);
+        os << endl;
+    }
+}
+
 void clear_impartial_sumgame_ttable()
 {
     THROW_ASSERT(global::clear_tt());
@@ -21,6 +21,7 @@
 #include <cstddef>
 #include <string>
 #include <cstdint>
+#include <ostream>
 #include "timeout_token.h"
 
 // solve sumgame s - compute its nim_value
@@ -38,4 +39,7 @@ void init_impartial_sumgame_ttable(size_t idx_bits,
 
 void save_impartial_sumgame_ttable(const std::string& ttable_save_file_name);
 
+// Print store counters of the impartial ttable in use, if any
+void print_impartial_sumgame_ttable_stats(std::ostream& os);
+
 void clear_impartial_sumgame_ttable();
@@ -15,6 +15,7 @@
 
 #include "config_map.h"
 #include "database.h"
+#include "db_indexed_file.h"
 #include "sumgame.h"
 #include "db_game_generator.h"
 #include "db_make_simplest_equal_game.h"
@@ -161,6 +162,9 @@ create_generator_and_options(const db_game_gen_registration_t& reg,
 
     config.check_unused_keys();
 
+    // Not part of the config string; doesn't change entries
+    opts.n_threads = global::db_gen_threads();
+
     return p;
 }
 
@@ -218,6 +222,13 @@ void fill_database(database& db, const string& db_config_string, bool dry_run)
             {
                 reinitialize_equivalence_classes(db);
 
+                // When extending a loaded DB, new entries may link to old ones
+                if (!reg.is_impartial && *gen)
+                {
+                    unique_ptr<game> g(gen->gen_game());
+                    db.add_existing_entries_to_equivalence_classes(
+                        g->game_type());
+                }
 
                 assert_equivalence_classes_have_zero_entry(db);
 
@@ -280,7 +291,7 @@ void init_database(optional<string> filename, init_database_enum init_type,
     if (init_type == INIT_DATABASE_AUTO)
         init_type = resolve_auto_init_type(filename);
 
-    if (init_type == INIT_DATABASE_LOAD)
+    if (init_type == INIT_DATABASE_LOAD || init_type == INIT_DATABASE_EXTEND)
     {
         THROW_ASSERT(filename.has_value());
 
@@ -297,11 +308,26 @@ void init_database(optional<string> filename, init_database_enum init_type,
         THROW_ASSERT(filename.has_value());
 
         fill_database(db, db_config_string, false);
-        db.save(*filename);
+        db.save(*filename, global::db_file_indexed() ? DB_FILE_FORMAT_INDEXED
+                                                     : DB_FILE_FORMAT_STREAM);
         cout << "Database file saved:";
         cout << " \"" << *filename << "\"" << endl;
     }
 
+    if (init_type == INIT_DATABASE_EXTEND)
+    {
+        THROW_ASSERT(filename.has_value());
+
+        const bool indexed = global::db_file_indexed() ||
+                             db_indexed_file::is_indexed_file(*filename);
+
+        fill_database(db, db_config_string, false);
+        db.save(*filename,
+                indexed ? DB_FILE_FORMAT_INDEXED : DB_FILE_FORMAT_STREAM);
+        cout << "Database file extended:";
+        cout << " \"" << *filename << "\"" << endl;
+    }
+
     if (init_type != INIT_DATABASE_NONE && global::print_db_info())
     {
         cout << "Database info: " << endl;
@@ -10,6 +10,7 @@ enum init_database_enum
     INIT_DATABASE_AUTO,
     INIT_DATABASE_CREATE,
     INIT_DATABASE_LOAD,
+    INIT_DATABASE_EXTEND,
 };
 
 namespace mcgs_init {
@@ -194,6 +194,20 @@ private:
     const std::vector<uint8_t>& _data_vec;
 };
 
+////////////////////////////////////////////////// class range_ibuffer
+// Reads from memory owned by the caller, i.e. part of a mapped file
+class range_ibuffer: public i_ibuffer
+{
+public:
+    range_ibuffer(const uint8_t* data, size_t n_bytes);
+    ~range_ibuffer();
+
+    size_t bytes_read() const;
+
+protected:
+    void _preload_bytes(size_t n_bytes) override;
+};
+
 ////////////////////////////////////////////////// class memory_obuffer
 class memory_obuffer: public i_obuffer
 {
@@ -591,6 +605,33 @@ inline void memory_ibuffer::_preload_bytes(size_t n_bytes)
 {
 }
 
+////////////////////////////////////////////////// range_ibuffer methods
+inline range_ibuffer::range_ibuffer(const uint8_t* data, size_t n_bytes)
+{
+    _buffer = data;
+    _buffer_idx = 0;
+    _buffer_size = n_bytes;
+}
+
+inline range_ibuffer::~range_ibuffer()
+{
+    _buffer = nullptr;
+    _buffer_idx = 0;
+    _buffer_size = 0;
+}
+
+inline size_t range_ibuffer::bytes_read() const
+{
+    return _buffer_idx;
+}
+
+inline void range_ibuffer::_preload_bytes(size_t n_bytes)
+{
+    // Nothing more to read
+    THROW_ASSERT(_remaining_unread_bytes() >= n_bytes,
+                 "range_ibuffer: read past end of range");
+}
+
 ////////////////////////////////////////////////// memory_obuffer methods
 inline memory_obuffer::memory_obuffer(): _data_vec(_INITIAL_BUFFER_SIZE)
 {
@@ -21,6 +21,7 @@
 #include "throw_assert.h"
 
 #include "gen_experiments.h"
+#include "bench_ttable.h"
 #include "basic_player.h"
 #include "utils_for_main.h"
 #include "warn_on_exit.h"
@@ -75,7 +76,8 @@ static int main_impl(int argc, char** argv, optional<cli_options>& opts_optional
         else
         {
             run_autotests(opts.test_directory, opts.outfile_name,
-                          opts.test_timeout, opts.test_filter_type);
+                          opts.test_timeout, opts.test_filter_type,
+                          opts.test_jobs);
         }
 
         return 0;
@@ -119,6 +121,12 @@ static int main_impl(int argc, char** argv, optional<cli_options>& opts_optional
         return 0;
     }
 
+    if (opts.bench_ttable_idx_bits.has_value())
+    {
+        bench_ttable(*opts.bench_ttable_idx_bits);
+        return 0;
+    }
+
     // Run sums from input
     if (opts.parser)
     {
@@ -153,5 +161,11 @@ int main(int argc, char** argv)
     if (!opts->tt_imp_sumgame_save_file_name.empty())
         save_impartial_sumgame_ttable(opts->tt_imp_sumgame_save_file_name);
 
+    if (global::print_ttable_stats())
+    {
+        sumgame::print_ttable_stats(cout);
+        print_impartial_sumgame_ttable_stats(cout);
+    }
+
     return status;
 }
@@ -0,0 +1,75 @@
+#include "mapped_file.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "throw_assert.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(_WIN32) || defined(_WIN64)
+mapped_file::mapped_file(const string& file_name, mapped_file_mode mode)
+    : _data(nullptr), _size(0), _mode(mode)
+{
+    THROW_ASSERT(false, "Can't map file \"" + file_name +
+                            "\": mapped files aren't supported on Windows");
+}
+
+mapped_file::~mapped_file()
+{
+}
+
+#else
+mapped_file::mapped_file(const string& file_name, mapped_file_mode mode)
+    : _data(nullptr), _size(0), _mode(mode)
+{
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    THROW_ASSERT(fd != -1, "Failed to open file \"" + file_name + "\"!");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        THROW_ASSERT(false, "Failed to stat file \"" + file_name + "\"!");
+    }
+
+    _size = st.st_size;
+
+    if (_size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    const int prot = (mode == MAPPED_FILE_READ_ONLY) ? PROT_READ
+                                                     : (PROT_READ | PROT_WRITE);
+
+    void* addr = mmap(nullptr, _size, prot, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+
+    THROW_ASSERT(addr != MAP_FAILED, "Failed to map file \"" + file_name +
+                                         "\"!");
+
+    _data = static_cast<uint8_t*>(addr);
+}
+
+mapped_file::~mapped_file()
+{
+    if (_data != nullptr)
+    {
+        [[maybe_unused]] const int status = munmap(_data, _size);
+        assert(status == 0);
+    }
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+    Memory mapping of an entire file, unmapped on destruction
+
+    MAPPED_FILE_READ_ONLY: pages can only be read
+
+    MAPPED_FILE_COPY_ON_WRITE: pages can be written, but writes are private
+        to this process, and never reach the file. Processes mapping the same
+        file share its unmodified pages through the OS page cache
+
+    Not supported on Windows (see mapped_file::SUPPORTED); the constructor
+    throws there.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum mapped_file_mode
+{
+    MAPPED_FILE_READ_ONLY = 0,
+    MAPPED_FILE_COPY_ON_WRITE,
+};
+
+////////////////////////////////////////////////// class mapped_file
+class mapped_file
+{
+public:
+#if defined(_WIN32) || defined(_WIN64)
+    static constexpr bool SUPPORTED = false;
+#else
+    static constexpr bool SUPPORTED = true;
+#endif
+
+    // Throws if the file can't be opened or mapped
+    mapped_file(const std::string& file_name, mapped_file_mode mode);
+    ~mapped_file();
+
+    // no copy
+    mapped_file(const mapped_file& rhs) = delete;
+    mapped_file& operator=(const mapped_file& rhs) = delete;
+
+    // Page aligned. nullptr if the file is empty
+    uint8_t* data() const;
+    size_t size() const;
+
+    mapped_file_mode mode() const;
+
+private:
+    uint8_t* _data;
+    size_t _size;
+    mapped_file_mode _mode;
+};
+
+////////////////////////////////////////////////// mapped_file implementation
+inline uint8_t* mapped_file::data() const
+{
+    return _data;
+}
+
+inline size_t mapped_file::size() const
+{
+    return _size;
+}
+
+inline mapped_file_mode mapped_file::mode() const
+{
+    return _mode;
+}
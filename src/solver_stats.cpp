@@ -1,5 +1,6 @@
 #include "solver_stats.h"
 
+#include <algorithm>
 #include <cassert>
 #include <unordered_set>
 #include <iostream>
@@ -13,7 +14,7 @@
 #include "sumgame.h"
 
 // Global solver_stats object
-solver_stats stats::__global_stats;
+thread_local solver_stats stats::__global_stats;
 
 ////////////////////////////////////////////////// solver_stats methods
 void solver_stats::reset()
@@ -90,6 +91,27 @@ void solver_stats::print_search_statistics(std::ostream& ostr) const
 #undef PRINT_FIELD
 #undef PRINT_FIELD_OPTIONAL
 
+void solver_stats::merge(const solver_stats& other)
+{
+    // TT accesses
+    tt_hits += other.tt_hits;
+    tt_misses += other.tt_misses;
+
+    // DB accesses
+    db_hits += other.db_hits;
+    db_misses += other.db_misses;
+
+    // Nodes
+    search_node_count += other.search_node_count;
+    if (search_node_hashes.has_value() && other.search_node_hashes.has_value())
+        search_node_hashes->insert(other.search_node_hashes->begin(),
+                                   other.search_node_hashes->end());
+    max_search_depth = std::max(max_search_depth, other.max_search_depth);
+
+    // Subgames
+    max_subgame_count = std::max(max_subgame_count, other.max_subgame_count);
+}
+
 std::optional<double> solver_stats::get_tt_hit_rate() const
 {
     const uint64_t total = tt_hits + tt_misses;
@@ -113,26 +135,32 @@ std::optional<double> solver_stats::get_db_hit_rate() const
 ////////////////////////////////////////////////// Stats/reporting functions
 namespace stats {
 namespace {
-std::optional<global_hash> hash_helper;
+// Initialized by mcgs_init for the main thread, and lazily for other threads
+thread_local std::optional<global_hash> hash_helper;
+
+global_hash& get_hash_helper_for_thread()
+{
+    if (!hash_helper.has_value()) [[unlikely]]
+        hash_helper.emplace();
+
+    return hash_helper.value();
+}
 
 hash_t get_node_hash(const std::vector<game*>& games, ebw to_play)
 {
-    assert(hash_helper.has_value());
-    return hash_helper->get_global_hash_value(games, to_play);
+    return get_hash_helper_for_thread().get_global_hash_value(games, to_play);
 }
 
 hash_t get_node_hash(const game* g, ebw to_play)
 {
-    assert(hash_helper.has_value());
-    return hash_helper->get_global_hash_value(g, to_play);
+    return get_hash_helper_for_thread().get_global_hash_value(g, to_play);
 }
 
 } // namespace
 
 global_hash& get_global_hash_helper()
 {
-    assert(hash_helper.has_value());
-    return hash_helper.value();
+    return get_hash_helper_for_thread();
 }
 
 void __report_search_node_initial(size_t initial_subgame_count)
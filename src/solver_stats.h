@@ -3,6 +3,10 @@
 
     Must call reset_stats() before every test case. This should be done
     in i_test_case::run()
+
+    The global solver_stats object is thread local. Parallel search workers
+    collect their own stats, which are then merged into the calling thread's
+    stats (see solver_stats::merge()).
 */
 #pragma once
 
@@ -28,6 +32,9 @@ struct solver_stats
     void reset();
     void print_search_statistics(std::ostream& ostr) const;
 
+    // Add counts from another thread's stats. Initial values are not merged
+    void merge(const solver_stats& other);
+
     std::optional<double> get_tt_hit_rate() const;
     std::optional<double> get_db_hit_rate() const;
 
@@ -54,7 +61,8 @@ struct solver_stats
 
 // Global solver_stats object
 namespace stats {
-extern solver_stats __global_stats; // NOLINT(readability-identifier-naming)
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern thread_local solver_stats __global_stats;
 } // namespace stats
 
 ////////////////////////////////////////////////// Stats/reporting functions
@@ -70,6 +78,14 @@ void reset_global_stats();
 void report_tt_access(bool hit);
 void report_db_access(bool hit);
 
+/*
+    Search nodes reported by this thread since search_node_count was
+    node_count_before. Gives the subtree size of a search node, for ttable
+    replacement policies
+*/
+uint64_t get_search_node_count();
+uint64_t search_nodes_since(uint64_t node_count_before);
+
 // Report per-node
 void report_search_node(const sumgame& sum, ebw to_play, uint64_t depth);
 void report_search_node(const std::vector<game*>& games, ebw to_play,
@@ -147,6 +163,17 @@ inline void report_db_access(bool hit)
         __global_stats.db_misses++;
 }
 
+inline uint64_t get_search_node_count()
+{
+    return __global_stats.search_node_count;
+}
+
+inline uint64_t search_nodes_since(uint64_t node_count_before)
+{
+    assert(__global_stats.search_node_count >= node_count_before);
+    return __global_stats.search_node_count - node_count_before;
+}
+
 inline void report_search_node(const sumgame& sum, ebw to_play, uint64_t depth)
 {
     const int n_active = sum.num_active_games();
@@ -13,13 +13,24 @@
 #include <set>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <exception>
+
+#ifndef __EMSCRIPTEN__
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 #include "sumgame.h"
 #include "database.h"
 #include "exit_signal.h"
-#include "iobuffer.h"
 #include "seg_replacer.h"
 #include "sumgame_helpers.h"
+#include "sumgame_move_ordering.h"
+#include "sumgame_search.h"
 #include "throw_assert.h"
 #include "bounds.h"
 #include "db_move_generator.h"
@@ -43,7 +54,6 @@
 #include "sumgame_change_record.h"
 #include "sumgame_undo_stack_unwinder.h"
 #include "impartial_game_wrapper.h"
-#include "transposition_serializer.h" // IWYU pragma: keep
 #include "utilities.h"
 #include "ThGraph.h"
 #include "ThValue.h"
@@ -195,6 +205,47 @@ private:
 
 } // namespace
 
+#ifndef __EMSCRIPTEN__
+namespace sumgame_impl {
+/*
+    Shared by the calling thread and worker threads of
+    sumgame::_solve_root_split()
+*/
+struct root_split_state
+{
+    root_split_state(const timeout_token& worker_tok, uint64_t depth)
+        : worker_tok(worker_tok),
+          depth(depth),
+          next_move_idx(0),
+          found_win(false),
+          n_workers_done(0),
+          winning_move_idx(0),
+          incomplete(false)
+    {
+    }
+
+    // Read only while workers run
+    const timeout_token worker_tok;
+    const uint64_t depth;
+    vector<sumgame_move> moves;
+    vector<int> subgame_map; // subgame index --> index in worker's clone
+
+    atomic<size_t> next_move_idx;
+    atomic<bool> found_win;
+
+    // Guarded by mutex
+    mutex mtx;
+    condition_variable cv;
+    size_t n_workers_done;
+    size_t winning_move_idx; // valid when found_win is true
+    bool incomplete; // some root move wasn't fully searched
+    vector<solver_stats> worker_stats;
+    exception_ptr worker_exception;
+};
+
+} // namespace sumgame_impl
+#endif
+
 ////////////////////////////////////////////////// sumgame methods
 void sumgame::add(game* g)
 {
@@ -463,21 +514,22 @@ bool sumgame::solve_with_games(const vector<game*>& games) const
 }
 
 optional<solve_result> sumgame::solve_with_timeout(
-    unsigned long long timeout) const
+    unsigned long long timeout, optional<sumgame_move>* winning_move) const
 {
     timeout_source src;
     timeout_token tok = src.get_timeout_token();
 
     src.start_timeout(timeout);
     optional<solve_result> result =
-        solve_with_timeout_token(tok, INITIAL_SEARCH_DEPTH);
+        solve_with_timeout_token(tok, INITIAL_SEARCH_DEPTH, winning_move);
     src.cancel_timeout();
 
     return result;
 }
 
 optional<solve_result> sumgame::solve_with_timeout_token(
-    const timeout_token& timeout_tok, uint64_t depth) const
+    const timeout_token& timeout_tok, uint64_t depth,
+    optional<sumgame_move>* winning_move) const
 {
     assert_restore_sumgame ars(*this);
     sumgame& sum = const_cast<sumgame&>(*this);
@@ -493,11 +545,37 @@ optional<solve_result> sumgame::solve_with_timeout_token(
     assert(_replacer == nullptr);
     _replacer = seg_replacer_new();
 
-    optional<solve_result> result = sum._solve_impl(depth);
+    assert(_move_orderer == nullptr);
+    const move_ordering_t ordering = get_global_move_ordering();
+
+    if (ordering != MOVE_ORDERING_NONE)
+        _move_orderer = new sumgame_move_orderer(ordering);
+
+    // The search graph is only recorded by minimax, and only minimax has
+    // depth limits
+    const bool use_minimax = sgraph::is_recording() || //
+                             _depth_limit != SUMGAME_NO_DEPTH_LIMIT;
+
+    const sumgame_search_algorithm algorithm =
+        use_minimax ? SUMGAME_SEARCH_MINIMAX : get_global_search_algorithm();
+
+    optional<solve_result> result =
+        get_sumgame_search(algorithm).solve(sum, depth);
+
+    if (winning_move != nullptr)
+    {
+        winning_move->reset();
+
+        if (result.has_value() && result->win)
+            *winning_move = sum._get_ttable_winning_move();
+    }
 
     seg_replacer_delete(_replacer);
     _replacer = nullptr;
 
+    delete _move_orderer;
+    _move_orderer = nullptr;
+
     sum._undo_pre_solve_pass();
 
     sum._timeout_tok.reset();
@@ -505,6 +583,26 @@ optional<solve_result> sumgame::solve_with_timeout_token(
     return result;
 }
 
+optional<solve_result> sumgame::solve_with_depth_limit(
+    const timeout_token& timeout_tok, uint64_t depth, uint64_t depth_limit,
+    bw horizon_winner) const
+{
+    assert(_depth_limit == SUMGAME_NO_DEPTH_LIMIT);
+    assert(depth_limit != SUMGAME_NO_DEPTH_LIMIT);
+    assert(is_black_white(horizon_winner));
+
+    _depth_limit = depth_limit;
+    _horizon_winner = horizon_winner;
+
+    optional<solve_result> result =
+        solve_with_timeout_token(timeout_tok, depth);
+
+    _depth_limit = SUMGAME_NO_DEPTH_LIMIT;
+    _horizon_winner = EMPTY;
+
+    return result;
+}
+
 void sumgame::simplify_basic()
 {
     if (!global::simplify_basic_cgt())
@@ -1058,16 +1156,51 @@ mcgs_player_move sumgame::get_winning_or_random_move(
     restore_sumgame_player restore_player(sum);
 
     sum.set_to_play(for_player);
-    unique_ptr<sumgame_move_generator> gen(
-        sum.create_sum_move_generator(for_player));
 
     vector<sumgame_move> moves;
 
-    while (*gen)
     {
-        moves.emplace_back(gen->gen_sum_move());
-        const sumgame_move& sm = moves.back();
-        ++(*gen);
+        unique_ptr<sumgame_move_generator> gen(
+            sum.create_sum_move_generator(for_player));
+
+        for (; *gen; ++(*gen))
+            moves.emplace_back(gen->gen_sum_move());
+    }
+
+    if (moves.empty())
+    {
+        assert(!pm.sm.has_value());
+        pm.status = MCGS_PLAYER_MOVE_STATUS_NO_MOVES;
+        return pm;
+    }
+
+    /*
+        Solve the sum first. A win's move is usually in the ttable, and a loss
+        means no move needs to be searched
+    */
+    optional<sumgame_move> winning_move;
+    const optional<solve_result> sum_result =
+        sum.solve_with_timeout(0, &winning_move);
+
+    CHECK_EXIT_SIGNAL_1({
+        assert(!pm.sm.has_value());
+        pm.status = MCGS_PLAYER_MOVE_STATUS_SHOULD_EXIT;
+        return pm;
+    });
+
+    THROW_ASSERT(sum_result.has_value());
+
+    if (winning_move.has_value())
+    {
+        pm.sm = winning_move;
+        pm.status = MCGS_PLAYER_MOVE_STATUS_OK;
+        return pm;
+    }
+
+    // Otherwise search each move
+    for (size_t i = 0; sum_result->win && i < moves.size(); i++)
+    {
+        const sumgame_move& sm = moves[i];
 
         assert(sum.to_play() == for_player);
         sum.play_sum(sm, for_player);
@@ -1093,13 +1226,6 @@ mcgs_player_move sumgame::get_winning_or_random_move(
         }
     }
 
-    if (moves.empty())
-    {
-        assert(!pm.sm.has_value());
-        pm.status = MCGS_PLAYER_MOVE_STATUS_NO_MOVES;
-        return pm;
-    }
-
     // TODO: random_generator should work for arbitrary types...
     const uint32_t choice = get_global_rng().get_u32(0, moves.size() - 1);
 
@@ -1125,14 +1251,16 @@ void sumgame::init_sumgame(size_t index_bits,
     assert(_tt.get() == nullptr); // Not already initialized
 
     if (ttable_load_file_name.empty())
-        _tt.reset(new ttable_sumgame(index_bits, 1));
+        _tt.reset(new ttable_sumgame(index_bits, TTABLE_SUMGAME_N_BOOLS,
+                                     get_global_tt_replacement_policy()));
     else
     {
         cout << "Loading partisan ttable \"" << ttable_load_file_name;
         cout << "\"..." << flush;
 
-        file_ibuffer is(ttable_load_file_name);
-        _tt.reset(serializer<ttable_sumgame*>::load(is, nullptr));
+        _tt.reset(new ttable_sumgame(ttable_sumgame::load_file(
+            ttable_load_file_name, TT_FILE_SUMGAME, global::tt_mmap())));
+        _tt->set_replacement_policy(get_global_tt_replacement_policy());
 
         const size_t new_index_bits = _tt->n_index_bits();
         global::tt_sumgame_idx_bits.set(new_index_bits);
@@ -1156,16 +1284,29 @@ void sumgame::save_ttable(const std::string& ttable_save_file_name)
     cout << "Saving partisan ttable \"" << ttable_save_file_name << "\"..."
          << flush;
 
-    file_obuffer os(ttable_save_file_name);
-    serializer<ttable_sumgame*>::save(os, _tt.get(), nullptr);
+    _tt->save_file(ttable_save_file_name, TT_FILE_SUMGAME);
 
     cout << " OK" << endl;
 }
 
+void sumgame::print_ttable_stats(std::ostream& os)
+{
+    if (_tt.get() == nullptr)
+        return;
+
+    os << "Partisan ttable ("
+       << ttable_replacement_policy_to_string(_tt->get_replacement_policy())
+       << ") ";
+    _tt->get_store_counts().print(os);
+    os << endl;
+}
+
 void sumgame::clear_ttable()
 {
     assert(global::clear_tt());
 
+    get_sumgame_search(get_global_search_algorithm()).clear_ttable();
+
     if (_tt.get() == nullptr)
     {
         assert(global::tt_sumgame_idx_bits() == 0);
@@ -1262,6 +1403,8 @@ optional<solve_result> sumgame::_solve_impl(uint64_t depth)
     if (_over_time())
         return solve_result::invalid();
 
+    // For ttable replacement policy
+    const uint64_t node_count_before = stats::get_search_node_count();
 
     stats::report_search_node(*this, to_play(), depth);
     const uint64_t next_depth = depth + 1; // for after a move is played
@@ -1299,24 +1442,89 @@ optional<solve_result> sumgame::_solve_impl(uint64_t depth)
     optional<ttable_sumgame::search_result> tt_result =
         _do_ttable_lookup();
 
-    if (tt_result.has_value() && tt_result->entry_valid())
+    if (tt_result.has_value() && _ttable_entry_solved(*tt_result))
     {
-        const bool win = tt_result->get_bool(0);
+        const bool win = tt_result->get_bool(TTABLE_SUMGAME_WIN);
         sgraph::pop_winloss(win);
         return win;
     }
 
     const bw toplay = to_play();
 
+    // At the depth limit, assume _horizon_winner wins
+    if (depth >= _depth_limit)
+    {
+        sgraph::pop(SEARCH_NODE_TYPE_PRUNED);
+        return solve_result(toplay == _horizon_winner, false);
+    }
+
+    /*
+        Entry from a depth limited search. If it searched at least as deep
+        below this node, assuming the same winner at its depth limit, its
+        result still holds; searching deeper can only make things worse for
+        _horizon_winner, who won it. Otherwise its move is tried first
+    */
+    optional<sumgame_move> tt_move;
+
+    if (tt_result.has_value() && tt_result->entry_valid())
+    {
+        assert(tt_result->get_bool(TTABLE_SUMGAME_HORIZON));
+
+        const bool win = tt_result->get_bool(TTABLE_SUMGAME_WIN);
+        const ttable_sumgame_entry entry = tt_result->get_entry();
+
+        const uint64_t plies =
+            min(_depth_limit - depth, TTABLE_SUMGAME_MAX_HORIZON_PLIES);
+
+        if ((win ? toplay : ::opponent(toplay)) == _horizon_winner &&
+            entry.horizon_plies >= plies)
+        {
+            sgraph::pop(SEARCH_NODE_TYPE_PRUNED);
+            return solve_result(win, false);
+        }
+
+        if (tt_result->get_bool(TTABLE_SUMGAME_HAS_MOVE))
+            tt_move = _find_ttable_move(entry, toplay);
+    }
+
     unique_ptr<sumgame_move_generator> mgp =
         make_unique<sumgame_move_generator>(*this, toplay, &temperatures,
                                             &dom_move_objects);
 
     sumgame_move_generator& mg = *mgp;
 
-    for (; mg; ++mg)
+    /*
+        With a move ordering or a ttable move, all moves are generated first,
+        then reordered. Otherwise moves are searched as they're generated
+    */
+    const bool ordered = (_move_orderer != nullptr) || tt_move.has_value();
+    vector<sumgame_move> ordered_moves;
+
+    // No move so far depended on nodes at the depth limit
+    bool all_proven = true;
+
+    if (ordered)
+    {
+        for (; mg; ++mg)
+            ordered_moves.push_back(mg.gen_sum_move());
+
+        if (_move_orderer != nullptr)
+            _move_orderer->order_moves(*this, toplay, depth, ordered_moves);
+
+        // May be missing, i.e. if pruned as a dominated move
+        auto it = tt_move.has_value() ? find(ordered_moves.begin(),
+                                             ordered_moves.end(), *tt_move)
+                                      : ordered_moves.end();
+
+        if (it != ordered_moves.end())
+            rotate(ordered_moves.begin(), it, it + 1);
+    }
+
+    for (size_t move_idx = 0;
+         ordered ? (move_idx < ordered_moves.size()) : bool(mg); move_idx++)
     {
-        const sumgame_move m = mg.gen_sum_move();
+        const sumgame_move m =
+            ordered ? ordered_moves[move_idx] : mg.gen_sum_move();
         play_sum(m, toplay);
 
         solve_result result(false);
@@ -1330,28 +1538,71 @@ optional<solve_result> sumgame::_solve_impl(uint64_t depth)
             if (!child_result.has_value() || _over_time())
                 return solve_result::invalid();
 
-            result.win = not child_result.value().win;
+            result = solve_result(not child_result.value().win,
+                                  child_result->proven);
         }
 
         undo_move();
 
         if (result.win)
         {
+            /*
+                Assuming the opponent wins at the depth limit can only
+                underestimate this player, so the win is proven anyway
+            */
+            result.proven = result.proven || (toplay != _horizon_winner);
+
             if (tt_result.has_value())
             {
-                tt_result->init_entry();
-                tt_result->set_bool(0, result.win);
+                if (result.proven)
+                    _store_ttable_win(*tt_result, *subgame(m.subgame_idx),
+                                      m.m);
+                else
+                    _store_ttable_horizon(*tt_result, true, &m, depth);
+
+                tt_result->set_effort(
+                    depth, stats::search_nodes_since(node_count_before));
             }
 
-            sgraph::pop_winloss(result.win);
+            if (_move_orderer != nullptr)
+                _move_orderer->add_killer(*this, m, depth);
+
+            if (result.proven)
+                sgraph::pop_winloss(result.win);
+            else
+                sgraph::pop(SEARCH_NODE_TYPE_PRUNED);
+
             return result;
         }
+
+        all_proven = all_proven && result.proven;
+
+        if (!ordered)
+            ++mg;
+    }
+
+    // As above, for the opponent
+    const bool proven = all_proven || (::opponent(toplay) != _horizon_winner);
+
+    if (!proven)
+    {
+        if (tt_result.has_value())
+        {
+            _store_ttable_horizon(*tt_result, false, nullptr, depth);
+            tt_result->set_effort(depth,
+                                  stats::search_nodes_since(node_count_before));
+        }
+
+        sgraph::pop(SEARCH_NODE_TYPE_PRUNED);
+        return solve_result(false, false);
     }
 
     if (tt_result.has_value())
     {
         tt_result->init_entry();
-        tt_result->set_bool(0, false);
+        tt_result->set_bool(TTABLE_SUMGAME_WIN, false);
+        tt_result->set_effort(depth,
+                              stats::search_nodes_since(node_count_before));
     }
 
 
@@ -1374,6 +1625,375 @@ optional<ttable_sumgame::search_result> sumgame::_do_ttable_lookup() const
     return sr;
 }
 
+namespace {
+inline uint32_t fold_to_32_bits(uint64_t value)
+{
+    return static_cast<uint32_t>(value ^ (value >> 32));
+}
+
+// Fits ttable_sumgame_entry::move_hash
+inline uint32_t fold_move_hash(const ::move& m)
+{
+    return fold_to_32_bits(static_cast<uint64_t>(m)) & 0xFFFFFF;
+}
+
+ttable_sumgame_entry make_ttable_entry(const game& g, const ::move& m)
+{
+    ttable_sumgame_entry entry = ttable_sumgame_entry();
+
+    entry.subgame_hash = fold_to_32_bits(g.get_local_hash());
+    entry.move_hash = fold_move_hash(m);
+
+    return entry;
+}
+
+} // namespace
+
+bool sumgame::_ttable_entry_solved(const ttable_sumgame::search_result& sr)
+{
+    return sr.entry_valid() && !sr.get_bool(TTABLE_SUMGAME_HORIZON);
+}
+
+void sumgame::_store_ttable_win(ttable_sumgame::search_result& sr,
+                                const game& g, const ::move& m)
+{
+    sr.init_entry(make_ttable_entry(g, m));
+    sr.set_bool(TTABLE_SUMGAME_WIN, true);
+    sr.set_bool(TTABLE_SUMGAME_HAS_MOVE, true);
+}
+
+void sumgame::_store_ttable_horizon(ttable_sumgame::search_result& sr,
+                                    bool win, const sumgame_move* winning_move,
+                                    uint64_t depth) const
+{
+    assert(depth < _depth_limit && _depth_limit != SUMGAME_NO_DEPTH_LIMIT);
+
+    ttable_sumgame_entry entry = ttable_sumgame_entry();
+
+    if (winning_move != nullptr)
+        entry = make_ttable_entry(*subgame_const(winning_move->subgame_idx),
+                                  winning_move->m);
+
+    entry.horizon_plies = static_cast<uint32_t>(
+        min(_depth_limit - depth, TTABLE_SUMGAME_MAX_HORIZON_PLIES));
+
+    sr.init_entry(entry);
+    sr.set_bool(TTABLE_SUMGAME_WIN, win);
+    sr.set_bool(TTABLE_SUMGAME_HAS_MOVE, winning_move != nullptr);
+    sr.set_bool(TTABLE_SUMGAME_HORIZON, true);
+}
+
+optional<sumgame_move> sumgame::_find_ttable_move(
+    const ttable_sumgame_entry& entry, bw to_play) const
+{
+    const int n_games = num_total_games();
+
+    for (int subgame_idx = 0; subgame_idx < n_games; subgame_idx++)
+    {
+        const game* g = subgame_const(subgame_idx);
+
+        if (!g->is_active() ||
+            fold_to_32_bits(g->get_local_hash()) != entry.subgame_hash)
+            continue;
+
+        unique_ptr<move_generator> mg(g->create_move_generator(to_play));
+
+        for (; *mg; ++(*mg))
+        {
+            const ::move m = mg->gen_move();
+
+            if (fold_move_hash(m) == entry.move_hash)
+                return sumgame_move(subgame_idx, m);
+        }
+    }
+
+    return {};
+}
+
+optional<sumgame_move> sumgame::_get_ttable_winning_move()
+{
+    optional<ttable_sumgame_entry> entry;
+
+    /*
+        The move was found in the simplified sum, so it may be in a subgame
+        which only exists until the passes are undone. Look for it after
+    */
+    {
+        undo_stack_unwinder stack_unwinder(*this);
+
+        temperature_vec_t temperatures;
+        dom_object_vec_t dom_move_objects;
+
+        // Same passes as _solve_impl(), so that the hash is the same
+        db_replacement_pass();
+        seg_pass(_replacer);
+        simplify_basic();
+
+        if (db_lookup_pass(temperatures, dom_move_objects).has_value())
+            return {};
+
+        optional<ttable_sumgame::search_result> tt_result =
+            _do_ttable_lookup();
+
+        if (tt_result.has_value() && _ttable_entry_solved(*tt_result) &&
+            tt_result->get_bool(TTABLE_SUMGAME_HAS_MOVE))
+            entry = tt_result->get_entry();
+    }
+
+    if (!entry.has_value())
+        return {};
+
+    return _find_ttable_move(*entry, to_play());
+}
+
+#ifndef __EMSCRIPTEN__
+optional<solve_result> sumgame::_solve_root_split(uint64_t depth)
+{
+#ifdef SUMGAME_DEBUG
+    _debug_extra();
+    assert_restore_sumgame ars(*this); // must come before the stack unwinder
+#endif
+
+    undo_stack_unwinder stack_unwinder(*this);
+
+    if (_over_time())
+        return solve_result::invalid();
+
+    // Includes worker nodes, after their stats are merged
+    const uint64_t node_count_before = stats::get_search_node_count();
+
+    stats::report_search_node(*this, to_play(), depth);
+
+    // Root node is simplified and looked up as in _solve_impl()
+    temperature_vec_t temperatures;
+    dom_object_vec_t dom_move_objects;
+
+    {
+        db_replacement_pass();
+        seg_pass(_replacer);
+        simplify_basic();
+
+        optional<solve_result> result =
+            db_lookup_pass(temperatures, dom_move_objects);
+
+        if (result.has_value())
+            return result;
+    }
+
+    optional<ttable_sumgame::search_result> tt_result =
+        _do_ttable_lookup();
+
+    if (tt_result.has_value() && _ttable_entry_solved(*tt_result))
+        return solve_result(tt_result->get_bool(TTABLE_SUMGAME_WIN));
+
+    // Workers stop when this source is cancelled
+    timeout_source worker_src;
+    worker_src.start_timeout(0);
+
+    sumgame_impl::root_split_state state(worker_src.get_timeout_token(),
+                                         depth);
+
+    const bw toplay = to_play();
+
+    for (sumgame_move_generator mg(*this, toplay, &temperatures,
+                                   &dom_move_objects);
+         mg; ++mg)
+        state.moves.push_back(mg.gen_sum_move());
+
+    if (_move_orderer != nullptr)
+        _move_orderer->order_moves(*this, toplay, depth, state.moves);
+
+    const size_t n_workers = min(global::threads(), state.moves.size());
+    state.worker_stats.resize(n_workers);
+
+    // Each worker gets a clone of the active games. The ttable is shared
+    const int n_games = num_total_games();
+    state.subgame_map.resize(n_games, -1);
+
+    vector<unique_ptr<sumgame>> worker_sums;
+    for (size_t i = 0; i < n_workers; i++)
+    {
+        sumgame* worker_sum = new sumgame(toplay);
+        worker_sums.emplace_back(worker_sum);
+
+        for (int subgame_idx = 0; subgame_idx < n_games; subgame_idx++)
+        {
+            const game* g = subgame_const(subgame_idx);
+            if (!g->is_active())
+                continue;
+
+            state.subgame_map[subgame_idx] = worker_sum->num_total_games();
+            worker_sum->add(g->clone());
+        }
+    }
+
+    /*
+        Random tables can't grow while workers read them. Sums can gain
+        subgames during search, so reserve extra hash modifiers first.
+    */
+    get_global_random_table(RANDOM_TABLE_MODIFIER).reserve(4 * n_games);
+    random_table::set_growth_locked(true);
+
+    vector<thread> workers;
+    for (size_t i = 0; i < n_workers; i++)
+        workers.emplace_back(&sumgame::_root_split_worker,
+                             worker_sums[i].get(), ref(state), i);
+
+    // Stop workers on timeout, winning move, or error
+    {
+        unique_lock<mutex> lock(state.mtx);
+        bool stopped = false;
+
+        while (state.n_workers_done < n_workers)
+        {
+            if (!stopped && (state.found_win || state.worker_exception ||
+                             _over_time()))
+            {
+                worker_src.cancel_timeout();
+                stopped = true;
+            }
+
+            state.cv.wait_for(lock, chrono::milliseconds(1));
+        }
+    }
+
+    for (thread& worker : workers)
+        worker.join();
+
+    random_table::set_growth_locked(false);
+
+    for (const solver_stats& worker_stats : state.worker_stats)
+        stats::__global_stats.merge(worker_stats);
+
+    for (unique_ptr<sumgame>& worker_sum : worker_sums)
+    {
+        for (game* g : worker_sum->_subgames)
+            delete g;
+        worker_sum->_subgames.clear();
+    }
+
+    if (state.worker_exception)
+        rethrow_exception(state.worker_exception);
+
+    const bool win = state.found_win;
+
+    if (!win && (state.incomplete || _over_time()))
+        return solve_result::invalid();
+
+    if (tt_result.has_value())
+    {
+        if (win)
+        {
+            const sumgame_move& sm = state.moves[state.winning_move_idx];
+            _store_ttable_win(*tt_result, *subgame(sm.subgame_idx), sm.m);
+        }
+        else
+        {
+            tt_result->init_entry();
+            tt_result->set_bool(TTABLE_SUMGAME_WIN, false);
+        }
+
+        tt_result->set_effort(depth,
+                              stats::search_nodes_since(node_count_before));
+    }
+
+    return solve_result(win);
+}
+
+void sumgame::_root_split_worker(sumgame_impl::root_split_state& state,
+                                 size_t worker_idx)
+{
+    stats::reset_global_stats();
+
+    _timeout_tok = state.worker_tok;
+    _need_cgt_simplify = true;
+    _replacer = seg_replacer_new();
+
+    // Killers aren't shared between workers
+    const move_ordering_t ordering = get_global_move_ordering();
+
+    if (ordering != MOVE_ORDERING_NONE)
+        _move_orderer = new sumgame_move_orderer(ordering);
+
+    bool incomplete = false;
+
+    try
+    {
+        const bw toplay = to_play();
+        const uint64_t next_depth = state.depth + 1;
+
+        while (!_over_time())
+        {
+            const size_t move_idx = state.next_move_idx.fetch_add(1);
+            if (move_idx >= state.moves.size())
+                break;
+
+            const sumgame_move& root_move = state.moves[move_idx];
+            const int subgame_idx = state.subgame_map[root_move.subgame_idx];
+            assert(subgame_idx >= 0);
+
+            play_sum(sumgame_move(subgame_idx, root_move.m), toplay);
+
+            bool win = false;
+
+            if (!find_static_winner(win))
+            {
+                optional<solve_result> child_result = _solve_impl(next_depth);
+
+                if (!child_result.has_value() || _over_time())
+                    incomplete = true;
+                else
+                    win = !child_result->win;
+            }
+
+            undo_move();
+
+            if (incomplete)
+                break;
+
+            if (win)
+            {
+                {
+                    lock_guard<mutex> lock(state.mtx);
+
+                    if (!state.found_win)
+                        state.winning_move_idx = move_idx;
+                    state.found_win.store(true);
+                }
+
+                state.cv.notify_one();
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        lock_guard<mutex> lock(state.mtx);
+
+        if (!state.worker_exception)
+            state.worker_exception = current_exception();
+    }
+
+    seg_replacer_delete(_replacer);
+    _replacer = nullptr;
+
+    delete _move_orderer;
+    _move_orderer = nullptr;
+
+    _timeout_tok.reset();
+
+    {
+        lock_guard<mutex> lock(state.mtx);
+
+        state.incomplete |= incomplete;
+        state.worker_stats[worker_idx] = stats::get_global_stats();
+        state.n_workers_done++;
+    }
+
+    state.cv.notify_one();
+}
+#endif
+
 void sumgame::_debug_extra() const
 {
     _assert_games_unique();
@@ -9,6 +9,7 @@
 #include <set>
 #include <optional>
 #include <cstdint>
+#include <cstddef>
 #include <utility>
 #include <ostream>
 #include <cassert>
@@ -18,13 +19,14 @@
 #include "game.h"
 #include "sumgame_change_record.h"
 #include "dominated_moves.h"
-#include "transposition.h"
+#include "transposition_concurrent.h"
 #include "timeout_token.h"
 #include "ThValue.h"
 
 ////////////////////////////////////////////////// Forward declarations
 namespace sumgame_impl {
 class change_record;
+struct root_split_state;
 }
 
 class sumgame_move_generator;
@@ -33,15 +35,43 @@ class assert_restore_sumgame;
 
 class seg_replacer;
 
+class sumgame_move_orderer;
+
 ////////////////////////////////////////////////// Simple types
 typedef std::vector<std::optional<ThValue>> temperature_vec_t;
 typedef std::vector<std::shared_ptr<const db_dom_moves_t>> dom_object_vec_t;
 
+/*
+    Winning move of a position, for the player to move. Identified by the
+    local hash of the move's subgame folded to 32 bits, and the move folded
+    to 24 bits. Subgame indices aren't stored, because they differ between
+    transpositions. Only meaningful when TTABLE_SUMGAME_HAS_MOVE is set.
+
+    Entries with TTABLE_SUMGAME_HORIZON set are results of depth limited
+    searches (see sumgame::solve_with_depth_limit()) which depended on the
+    depth limit, and aren't solved. horizon_plies is how many plies were
+    searched below the position (at most TTABLE_SUMGAME_MAX_HORIZON_PLIES)
+*/
 struct ttable_sumgame_entry
 {
+    uint32_t subgame_hash;
+    uint32_t move_hash : 24;
+    uint32_t horizon_plies : 8;
+};
+
+constexpr uint64_t TTABLE_SUMGAME_MAX_HORIZON_PLIES = 255;
+
+typedef concurrent_ttable<ttable_sumgame_entry> ttable_sumgame;
+
+// Packed bools of ttable_sumgame entries
+enum ttable_sumgame_bool
+{
+    TTABLE_SUMGAME_WIN = 0,
+    TTABLE_SUMGAME_HAS_MOVE,
+    TTABLE_SUMGAME_HORIZON,
 };
 
-typedef ttable<ttable_sumgame_entry> ttable_sumgame;
+constexpr size_t TTABLE_SUMGAME_N_BOOLS = 3;
 
 enum sumgame_undo_code
 {
@@ -116,7 +146,8 @@ struct play_record
 struct solve_result
 {
     solve_result() = delete;
-    solve_result(bool win) : win(win) {}
+    solve_result(bool win) : win(win), proven(true) {}
+    solve_result(bool win, bool proven) : win(win), proven(proven) {}
 
     // return this on timeout
     inline static std::optional<solve_result> invalid()
@@ -125,8 +156,15 @@ struct solve_result
     }
 
     bool win;
+
+    // false when `win` depends on the outcomes assumed by a depth limited
+    // search (see sumgame::solve_with_depth_limit())
+    bool proven;
 };
 
+// Depth limit of searches which aren't depth limited
+constexpr uint64_t SUMGAME_NO_DEPTH_LIMIT = UINT64_MAX;
+
 ////////////////////////////////////////////////// class sumgame
 class sumgame : public alternating_move_game
 {
@@ -199,6 +237,11 @@ public:
 
         Timeout is in milliseconds. 0 means never timeout. On timeout, the
         returned optional has no value.
+
+        The search algorithm is chosen by `global::search_algorithm()` (see
+        sumgame_search.h). When `global::threads()` is greater than 1, minimax
+        searches starting from INITIAL_SEARCH_DEPTH divide the root moves
+        between worker threads.
     */
     bool solve() const override;
 
@@ -208,10 +251,32 @@ public:
     bool solve_with_games(const std::vector<game*>& games) const;
 
     std::optional<solve_result> solve_with_timeout(
-        unsigned long long timeout) const;
+        unsigned long long timeout,
+        std::optional<sumgame_move>* winning_move = nullptr) const;
 
+    /*
+        When winning_move isn't nullptr and the sum is a win, it's set to the
+        winning move stored in the ttable entry of the sum, if any. The move
+        may be missing, i.e. when it was found in a subgame created by
+        simplification, or the ttable is disabled
+    */
     std::optional<solve_result> solve_with_timeout_token(
-        const timeout_token& timeout_tok, uint64_t depth) const;
+        const timeout_token& timeout_tok, uint64_t depth,
+        std::optional<sumgame_move>* winning_move = nullptr) const;
+
+    /*
+        Minimax search which doesn't expand nodes at `depth_limit` or deeper,
+        and assumes `horizon_winner` wins them. Uses minimax regardless of
+        `global::search_algorithm()`.
+
+        Assuming a player wins can only underestimate the opponent, so the
+        opponent's wins are always proven, as are results which didn't
+        depend on the depth limit. Only proven results are stored in the
+        ttable. Used by sumgame_iterative_deepening.h
+    */
+    std::optional<solve_result> solve_with_depth_limit(
+        const timeout_token& timeout_tok, uint64_t depth, uint64_t depth_limit,
+        bw horizon_winner) const;
 
     /*
         Simplification.
@@ -245,6 +310,9 @@ public:
 
     static void save_ttable(const std::string& ttable_save_file_name);
 
+    // Print replacement policy and store counts of the ttable
+    static void print_ttable_stats(std::ostream& os);
+
     // Called by derived classes of i_test_case, in their _run_impl() methods
     static void clear_ttable();
 
@@ -262,6 +330,12 @@ private:
     class undo_stack_unwinder;
     friend class assert_restore_sumgame;
 
+    // Search algorithms (see sumgame_search.h)
+    friend class minimax_search;
+    friend class dfpn_search;
+
+    friend class sumgame_move_orderer;
+
     /*
        Utilities.
     */
@@ -284,8 +358,40 @@ private:
     */
     std::optional<solve_result> _solve_impl(uint64_t depth);
 
+    /*
+        Parallel search at the root. Root moves are taken by worker threads,
+        each searching its own clone of the sum, and sharing `_tt`. All
+        workers stop as soon as one finds a winning move, or when
+        `_timeout_tok` stops the search.
+    */
+    std::optional<solve_result> _solve_root_split(uint64_t depth);
+    void _root_split_worker(sumgame_impl::root_split_state& state,
+                            size_t worker_idx);
+
     std::optional<ttable_sumgame::search_result> _do_ttable_lookup() const;
 
+    // Entry is valid and not from a depth limited search
+    static bool _ttable_entry_solved(const ttable_sumgame::search_result& sr);
+
+    // Store a win, and the move that won
+    static void _store_ttable_win(ttable_sumgame::search_result& sr,
+                                  const game& g, const ::move& m);
+
+    // Store a result which depended on the depth limit
+    void _store_ttable_horizon(ttable_sumgame::search_result& sr, bool win,
+                               const sumgame_move* winning_move,
+                               uint64_t depth) const;
+
+    // Move of this sum matching the entry's winning move
+    std::optional<sumgame_move> _find_ttable_move(
+        const ttable_sumgame_entry& entry, bw to_play) const;
+
+    /*
+        Simplify the sum as _solve_impl() does, and read the winning move from
+        its ttable entry. Must be called from solve_with_timeout_token()
+    */
+    std::optional<sumgame_move> _get_ttable_winning_move();
+
     /*
         Debugging/asserts.
     */
@@ -300,6 +406,14 @@ private:
     mutable global_hash _sumgame_hash;
     mutable seg_replacer* _replacer;
 
+    // Nodes at this depth or deeper aren't expanded by _solve_impl(), and
+    // are assumed to be wins for _horizon_winner
+    mutable uint64_t _depth_limit;
+    mutable bw _horizon_winner; // EMPTY when there's no depth limit
+
+    // nullptr when global::move_ordering() is "none"
+    mutable sumgame_move_orderer* _move_orderer;
+
     /*
         Persistent data. Has meaning outside of search.
     */
@@ -395,7 +509,12 @@ public:
 
 ////////////////////////////////////////////////// sumgame methods
 inline sumgame::sumgame(bw color)
-    : alternating_move_game(color), _need_cgt_simplify(true), _replacer(nullptr)
+    : alternating_move_game(color),
+      _need_cgt_simplify(true),
+      _replacer(nullptr),
+      _depth_limit(SUMGAME_NO_DEPTH_LIMIT),
+      _horizon_winner(EMPTY),
+      _move_orderer(nullptr)
 {
 }
 
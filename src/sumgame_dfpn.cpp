@@ -0,0 +1,263 @@
+#include "sumgame_dfpn.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "global_options.h"
+#include "hashing.h"
+#include "solver_stats.h"
+#include "sumgame.h"
+#include "sumgame_undo_stack_unwinder.h"
+#include "transposition_concurrent.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// Helpers
+namespace {
+constexpr ttable_dfpn_entry DFPN_PROVEN = {0, DFPN_INFINITY};
+constexpr ttable_dfpn_entry DFPN_DISPROVEN = {DFPN_INFINITY, 0};
+
+// Numbers of a node not in the ttable
+constexpr ttable_dfpn_entry DFPN_UNKNOWN = {1, 1};
+
+inline ttable_dfpn_entry solved_numbers(bool win)
+{
+    return win ? DFPN_PROVEN : DFPN_DISPROVEN;
+}
+
+inline bool is_solved(const ttable_dfpn_entry& numbers)
+{
+    return numbers.pn == 0 || numbers.dn == 0;
+}
+
+// Saturating. Only an infinite term makes the sum infinite
+inline dfpn_number_t add_numbers(dfpn_number_t a, dfpn_number_t b)
+{
+    if (a == DFPN_INFINITY || b == DFPN_INFINITY)
+        return DFPN_INFINITY;
+
+    const uint64_t sum = uint64_t(a) + uint64_t(b);
+    return static_cast<dfpn_number_t>(
+        min<uint64_t>(sum, DFPN_INFINITY - 1));
+}
+
+inline dfpn_number_t clamp_number(uint64_t number)
+{
+    return static_cast<dfpn_number_t>(min<uint64_t>(number, DFPN_INFINITY));
+}
+
+} // namespace
+
+////////////////////////////////////////////////// dfpn_search methods
+dfpn_search::dfpn_search()
+{
+}
+
+optional<solve_result> dfpn_search::solve(sumgame& sum, uint64_t depth)
+{
+    if (_tt.get() == nullptr)
+        _tt.reset(new ttable_dfpn(global::tt_dfpn_idx_bits(), 0,
+                                  get_global_tt_replacement_policy()));
+
+    optional<ttable_dfpn_entry> numbers =
+        _mid(sum, depth, DFPN_INFINITY, DFPN_INFINITY);
+
+    if (!numbers.has_value())
+        return solve_result::invalid();
+
+    assert(is_solved(*numbers));
+    return solve_result(numbers->pn == 0);
+}
+
+void dfpn_search::clear_ttable()
+{
+    if (_tt.get() != nullptr)
+        _tt->clear();
+}
+
+optional<ttable_dfpn_entry> dfpn_search::_mid(sumgame& sum, uint64_t depth,
+                                              dfpn_number_t thpn,
+                                              dfpn_number_t thdn)
+{
+#ifdef SUMGAME_DEBUG
+    sum._debug_extra();
+    assert_restore_sumgame ars(sum); // must come before the stack unwinder
+#endif
+
+    sumgame::undo_stack_unwinder stack_unwinder(sum);
+
+    if (sum._over_time())
+        return {};
+
+    // Parent reads this node's numbers before the node is simplified
+    const hash_t hash = sum.get_global_hash();
+
+    // For ttable replacement policy
+    const uint64_t node_count_before = stats::get_search_node_count();
+
+    stats::report_search_node(sum, sum.to_play(), depth);
+    const uint64_t next_depth = depth + 1; // for after a move is played
+
+    temperature_vec_t temperatures;
+    dom_object_vec_t dom_move_objects;
+
+    {
+        sum.db_replacement_pass();
+        sum.seg_pass(sum._replacer);
+        sum.simplify_basic();
+
+        optional<solve_result> result =
+            sum.db_lookup_pass(temperatures, dom_move_objects);
+
+        if (result.has_value())
+        {
+            const ttable_dfpn_entry numbers = solved_numbers(result->win);
+            _store(hash, numbers, depth, node_count_before);
+            return numbers;
+        }
+    }
+
+    // Solved by either search
+    optional<ttable_sumgame::search_result> tt_result =
+        sum._do_ttable_lookup();
+
+    if (tt_result.has_value() && sumgame::_ttable_entry_solved(*tt_result))
+    {
+        const ttable_dfpn_entry numbers =
+            solved_numbers(tt_result->get_bool(TTABLE_SUMGAME_WIN));
+        _store(hash, numbers, depth, node_count_before);
+        return numbers;
+    }
+
+    const bw toplay = sum.to_play();
+
+    /*
+        Children's numbers are read from the ttable once, then updated from
+        the results of searching them
+    */
+    vector<child_info> children;
+
+    for (sumgame_move_generator mg(sum, toplay, &temperatures,
+                                   &dom_move_objects);
+         mg; ++mg)
+    {
+        const sumgame_move sm = mg.gen_sum_move();
+        children.push_back({sm, _child_numbers(sum, sm, toplay)});
+    }
+
+    ttable_dfpn_entry numbers;
+    size_t best_idx;
+
+    while (true)
+    {
+        // With no children, the player to move loses
+        numbers = DFPN_DISPROVEN;
+
+        best_idx = 0;
+        dfpn_number_t second_dn = DFPN_INFINITY;
+
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            const ttable_dfpn_entry& child_numbers = children[i].numbers;
+
+            numbers.dn = add_numbers(numbers.dn, child_numbers.pn);
+
+            if (child_numbers.dn < numbers.pn)
+            {
+                second_dn = numbers.pn;
+                numbers.pn = child_numbers.dn;
+                best_idx = i;
+            }
+            else if (child_numbers.dn < second_dn)
+                second_dn = child_numbers.dn;
+        }
+
+        if (numbers.pn >= thpn || numbers.dn >= thdn)
+            break;
+
+        child_info& best = children[best_idx];
+
+        /*
+            Child's proof number becomes part of this node's disproof number,
+            and its disproof number is this node's proof number, until it
+            exceeds the second best child's. The 1 + epsilon trick (Pawlewicz
+            and Lew, 2007) lets the child exceed it by 1/4 before returning,
+            to avoid re-expanding nodes when two children are close
+        */
+        const dfpn_number_t child_thpn =
+            clamp_number(uint64_t(thdn) - numbers.dn + best.numbers.pn);
+        const dfpn_number_t child_thdn = clamp_number(min<uint64_t>(
+            thpn, uint64_t(second_dn) + second_dn / 4 + 1));
+
+        sum.play_sum(best.sm, toplay);
+        optional<ttable_dfpn_entry> child_result =
+            _mid(sum, next_depth, child_thpn, child_thdn);
+        sum.undo_move();
+
+        if (!child_result.has_value())
+            return {};
+
+        best.numbers = *child_result;
+    }
+
+    _store(hash, numbers, depth, node_count_before);
+
+    if (is_solved(numbers) && tt_result.has_value())
+    {
+        // A proven node's best child is disproven
+        if (numbers.pn == 0)
+        {
+            const sumgame_move& sm = children[best_idx].sm;
+            sumgame::_store_ttable_win(*tt_result, *sum.subgame(sm.subgame_idx),
+                                       sm.m);
+        }
+        else
+        {
+            tt_result->init_entry();
+            tt_result->set_bool(TTABLE_SUMGAME_WIN, false);
+        }
+
+        tt_result->set_effort(depth,
+                              stats::search_nodes_since(node_count_before));
+    }
+
+    return numbers;
+}
+
+ttable_dfpn_entry dfpn_search::_child_numbers(sumgame& sum,
+                                              const sumgame_move& sm,
+                                              bw to_play)
+{
+    ttable_dfpn_entry numbers = DFPN_UNKNOWN;
+
+    sum.play_sum(sm, to_play);
+
+    bool mover_wins;
+    if (sum.find_static_winner(mover_wins))
+        numbers = solved_numbers(!mover_wins);
+    else
+    {
+        optional<ttable_dfpn_entry> entry = _tt->get(sum.get_global_hash());
+        stats::report_tt_access(entry.has_value());
+
+        if (entry.has_value())
+            numbers = *entry;
+    }
+
+    sum.undo_move();
+
+    return numbers;
+}
+
+void dfpn_search::_store(hash_t hash, const ttable_dfpn_entry& numbers,
+                         uint64_t depth, uint64_t node_count_before)
+{
+    ttable_dfpn::search_result sr = _tt->search(hash);
+    sr.set_entry(numbers);
+    sr.set_effort(depth, stats::search_nodes_since(node_count_before));
+}
@@ -0,0 +1,84 @@
+/*
+    Depth-first proof-number search (df-pn) for sumgame
+
+    Nodes are expanded as in sumgame::_solve_impl(): the same simplification
+    passes, DB lookups, sumgame ttable lookups and sumgame_move_generator.
+    Instead of searching moves in order, df-pn always descends into the child
+    that looks easiest to resolve, and leaves it once a sibling looks easier.
+    This helps in unbalanced trees, where minimax can spend most of its time
+    in subtrees that are eventually refuted.
+
+    Proof and disproof numbers are for the player to move at each node: a
+    node's proof number is the smallest disproof number of its children, and
+    its disproof number is the sum of their proof numbers. They're stored in a
+    separate ttable_dfpn, keyed by the sum's global hash before simplification
+    (so a parent can read them after playing a move). Solved nodes are also
+    stored in sumgame's ttable, as minimax would store them.
+
+    See Nagai, "Df-pn Algorithm for Searching AND/OR Trees and Its
+    Applications" (2002).
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "sumgame.h"
+#include "sumgame_search.h"
+#include "transposition_concurrent.h"
+
+typedef uint32_t dfpn_number_t;
+
+// Proof/disproof number of a solved node
+constexpr dfpn_number_t DFPN_INFINITY = UINT32_MAX;
+
+struct ttable_dfpn_entry
+{
+    dfpn_number_t pn;
+    dfpn_number_t dn;
+};
+
+typedef concurrent_ttable<ttable_dfpn_entry> ttable_dfpn;
+
+////////////////////////////////////////////////// class dfpn_search
+class dfpn_search : public i_sumgame_search
+{
+public:
+    dfpn_search();
+
+    /*
+        Allocates the ttable on first use, with global::tt_dfpn_idx_bits
+        index bits
+    */
+    std::optional<solve_result> solve(sumgame& sum, uint64_t depth) override;
+
+    void clear_ttable() override;
+
+private:
+    struct child_info
+    {
+        sumgame_move sm;
+        ttable_dfpn_entry numbers;
+    };
+
+    /*
+        Multiple iterative deepening: search the sum until its proof number
+        reaches thpn, or its disproof number reaches thdn. Returns the sum's
+        numbers, or no value on timeout
+    */
+    std::optional<ttable_dfpn_entry> _mid(sumgame& sum, uint64_t depth,
+                                          dfpn_number_t thpn,
+                                          dfpn_number_t thdn);
+
+    // Numbers of sum after playing sm, from its ttable_dfpn entry
+    ttable_dfpn_entry _child_numbers(sumgame& sum, const sumgame_move& sm,
+                                     bw to_play);
+
+    void _store(hash_t hash, const ttable_dfpn_entry& numbers, uint64_t depth,
+                uint64_t node_count_before);
+
+    std::unique_ptr<ttable_dfpn> _tt;
+};
@@ -0,0 +1,108 @@
+#include "sumgame_iterative_deepening.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "solver_stats.h"
+#include "sumgame.h"
+#include "timeout_token.h"
+
+using namespace std;
+
+iterative_deepening_result solve_iterative_deepening(
+    const sumgame& sum, unsigned long long timeout)
+{
+    timeout_source src;
+    timeout_token tok = src.get_timeout_token();
+
+    src.start_timeout(timeout);
+    iterative_deepening_result result =
+        solve_iterative_deepening_with_token(sum, tok);
+    src.cancel_timeout();
+
+    return result;
+}
+
+iterative_deepening_result solve_iterative_deepening_with_token(
+    const sumgame& const_sum, const timeout_token& timeout_tok)
+{
+    assert_restore_sumgame ars(const_sum);
+    sumgame& sum = const_cast<sumgame&>(const_sum);
+
+    const bw to_play = sum.to_play();
+
+    iterative_deepening_result result;
+
+    {
+        unique_ptr<sumgame_move_generator> gen(
+            sum.create_sum_move_generator(to_play));
+
+        for (; *gen; ++(*gen))
+            result.unresolved_moves.push_back(gen->gen_sum_move());
+    }
+
+    // Root moves are at INITIAL_SEARCH_DEPTH, so positions after them are 1
+    // deeper
+    const uint64_t child_depth = INITIAL_SEARCH_DEPTH + 1;
+
+    for (uint64_t plies = 1; !result.unresolved_moves.empty(); plies *= 2)
+    {
+        vector<sumgame_move> still_unresolved;
+        const vector<sumgame_move>& moves = result.unresolved_moves;
+
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            const sumgame_move& sm = moves[i];
+
+            sum.play_sum(sm, to_play);
+
+            // Assuming the opponent wins at the depth limit proves wins
+            const optional<solve_result> child_result =
+                sum.solve_with_depth_limit(timeout_tok, child_depth,
+                                           child_depth + plies,
+                                           opponent(to_play));
+            sum.undo_move();
+
+            /*
+                Stop on timeout or win. Moves not searched by this iteration
+                stay unresolved
+            */
+            const bool win = child_result.has_value() &&
+                             child_result->proven && !child_result->win;
+
+            if (!child_result.has_value() || win)
+            {
+                if (win)
+                {
+                    result.win = true;
+                    result.winning_move = sm;
+                }
+
+                const size_t first_unsearched = win ? i + 1 : i;
+
+                still_unresolved.insert(still_unresolved.end(),
+                                        moves.begin() + first_unsearched,
+                                        moves.end());
+                result.unresolved_moves = still_unresolved;
+                return result;
+            }
+
+            if (child_result->proven)
+                result.losing_moves.push_back(sm);
+            else
+                still_unresolved.push_back(sm);
+        }
+
+        result.unresolved_moves = still_unresolved;
+        result.completed_depth = plies;
+    }
+
+    // Every move (if any) loses
+    result.win = false;
+    return result;
+}
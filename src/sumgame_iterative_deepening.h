@@ -0,0 +1,63 @@
+/*
+    Iterative deepening for sumgame
+
+    Root moves are searched by a sequence of depth limited minimax searches
+    (sumgame::solve_with_depth_limit()), which assume the opponent wins at
+    the depth limit. A move found to win under this assumption is proven to
+    win. A move found to lose is only proven to lose if the result didn't
+    depend on the depth limit. The depth limit doubles each iteration, so the
+    last iteration dominates the total work.
+
+    Root moves proven to win or lose are dropped from later iterations. The
+    sumgame ttable keeps proven positions between iterations, and the moves
+    which won positions at the previous depth limit, which are tried first.
+
+    When the timeout runs out, the result has the progress made so far: root
+    moves proven to lose, and moves not yet resolved.
+
+    Uses the same ttable, simplification passes and move ordering as minimax
+    search. global::search_algorithm is ignored.
+*/
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "sumgame.h"
+#include "timeout_token.h"
+
+////////////////////////////////////////////////// iterative_deepening_result
+struct iterative_deepening_result
+{
+    iterative_deepening_result();
+
+    // Whether the player to move wins. No value if the sum wasn't solved
+    std::optional<bool> win;
+
+    // Root move proven to win. Only when win is true
+    std::optional<sumgame_move> winning_move;
+
+    std::vector<sumgame_move> losing_moves; // proven to lose
+    std::vector<sumgame_move> unresolved_moves;
+
+    /*
+        Number of plies below each root move searched by the last complete
+        iteration. 0 if no iteration completed
+    */
+    uint64_t completed_depth;
+};
+
+////////////////////////////////////////////////// solving functions
+// Timeout is in milliseconds. 0 means never timeout
+iterative_deepening_result solve_iterative_deepening(
+    const sumgame& sum, unsigned long long timeout);
+
+iterative_deepening_result solve_iterative_deepening_with_token(
+    const sumgame& sum, const timeout_token& timeout_tok);
+
+////////////////////////////////////////////////// iterative_deepening_result methods
+inline iterative_deepening_result::iterative_deepening_result()
+    : completed_depth(0)
+{
+}
@@ -0,0 +1,343 @@
+#include "sumgame_move_ordering.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ThGraph.h"
+#include "ThValue.h"
+#include "cgt_basics.h"
+#include "database.h"
+#include "global_database.h"
+#include "global_options.h"
+#include "solver_stats.h"
+#include "sumgame.h"
+#include "throw_assert.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// Helpers
+namespace {
+const char* heuristic_name(move_ordering_heuristic heuristic)
+{
+    switch (heuristic)
+    {
+        case MOVE_ORDERING_TT:
+            return "tt";
+        case MOVE_ORDERING_KILLER:
+            return "killer";
+        case MOVE_ORDERING_DB:
+            return "db";
+    }
+
+    assert(false);
+    return "";
+}
+
+constexpr move_ordering_heuristic ALL_HEURISTICS[] = {
+    MOVE_ORDERING_TT,
+    MOVE_ORDERING_KILLER,
+    MOVE_ORDERING_DB,
+};
+
+// Moves are sorted by tier first
+enum move_tier
+{
+    MOVE_TIER_KNOWN_WIN = 0,
+    MOVE_TIER_KILLER,
+    MOVE_TIER_OTHER,
+    MOVE_TIER_KNOWN_LOSS,
+};
+
+struct scored_move
+{
+    sumgame_move sm;
+    move_tier tier;
+
+    // Position of the move's subgame in the generated moves
+    size_t subgame_rank;
+
+    // From the DB. Higher is better for the player to move
+    int outcome_score;
+
+    // Hottest resulting subgame
+    optional<ThValue> temperature;
+};
+
+bool operator<(const scored_move& lhs, const scored_move& rhs)
+{
+    if (lhs.tier != rhs.tier)
+        return lhs.tier < rhs.tier;
+
+    // Known wins, losses and killers keep their generated order
+    if (lhs.tier != MOVE_TIER_OTHER)
+        return false;
+
+    if (lhs.subgame_rank != rhs.subgame_rank)
+        return lhs.subgame_rank < rhs.subgame_rank;
+
+    if (lhs.outcome_score != rhs.outcome_score)
+        return lhs.outcome_score > rhs.outcome_score;
+
+    // Moves with temperatures first, coolest first
+    if (lhs.temperature.has_value())
+    {
+        if (!rhs.temperature.has_value())
+            return true;
+
+        return *lhs.temperature < *rhs.temperature;
+    }
+
+    return false;
+}
+
+/*
+    Score of a subgame resulting from a move by `mover`, with the opponent to
+    play next
+*/
+int outcome_score_for_mover(outcome_class oc, bw mover)
+{
+    const outcome_class mover_wins = (mover == BLACK) ? L : R;
+    const outcome_class opponent_wins = (mover == BLACK) ? R : L;
+
+    if (oc == mover_wins)
+        return 2;
+    if (oc == P)
+        return 1;
+    if (oc == N)
+        return -1;
+    if (oc == opponent_wins)
+        return -2;
+
+    return 0;
+}
+
+// Subgame has neither player's moves, and is 0
+constexpr int ENDED_SUBGAME_SCORE = 1;
+
+void add_db_score(const game& g, bw mover, scored_move& scored)
+{
+    if (g.is_impartial())
+        return;
+
+    const db_entry_partisan* entry = get_global_database().get_partisan_ptr(g);
+    stats::report_db_access(entry != nullptr);
+
+    if (entry == nullptr)
+        return;
+
+    scored.outcome_score += outcome_score_for_mover(entry->outcome, mover);
+
+    if (entry->thermograph)
+    {
+        const ThValue temp = entry->thermograph->Temperature();
+
+        if (!scored.temperature.has_value() || *scored.temperature < temp)
+            scored.temperature = temp;
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////// move_ordering_t
+string move_ordering_to_string(move_ordering_t ordering)
+{
+    if (ordering == MOVE_ORDERING_NONE)
+        return "none";
+
+    string str;
+
+    for (move_ordering_heuristic heuristic : ALL_HEURISTICS)
+    {
+        if ((ordering & heuristic) == 0)
+            continue;
+
+        if (!str.empty())
+            str.push_back(',');
+        str += heuristic_name(heuristic);
+    }
+
+    return str;
+}
+
+optional<move_ordering_t> move_ordering_from_string(const string& str)
+{
+    if (str == "none")
+        return MOVE_ORDERING_NONE;
+
+    if (str == "all")
+        return MOVE_ORDERING_ALL;
+
+    move_ordering_t ordering = MOVE_ORDERING_NONE;
+
+    stringstream stream(str);
+    string name;
+
+    while (getline(stream, name, ','))
+    {
+        bool found = false;
+
+        for (move_ordering_heuristic heuristic : ALL_HEURISTICS)
+        {
+            if (name == heuristic_name(heuristic))
+            {
+                ordering |= heuristic;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return {};
+    }
+
+    if (ordering == MOVE_ORDERING_NONE)
+        return {};
+
+    return ordering;
+}
+
+move_ordering_t get_global_move_ordering()
+{
+    optional<move_ordering_t> ordering =
+        move_ordering_from_string(global::move_ordering());
+
+    THROW_ASSERT(ordering.has_value(), "Invalid move ordering \"" +
+                                           global::move_ordering() + "\"");
+
+    return ordering.value();
+}
+
+////////////////////////////////////////////////// sumgame_move_orderer methods
+sumgame_move_orderer::sumgame_move_orderer(move_ordering_t ordering)
+    : _ordering(ordering)
+{
+}
+
+void sumgame_move_orderer::order_moves(sumgame& sum, bw to_play,
+                                       uint64_t depth,
+                                       vector<sumgame_move>& moves)
+{
+    if (_ordering == MOVE_ORDERING_NONE || moves.size() < 2)
+        return;
+
+    const bool use_tt = (_ordering & MOVE_ORDERING_TT) != 0 && //
+                        sumgame::_tt != nullptr &&              //
+                        global::tt_sumgame_idx_bits() > 0;      //
+
+    const bool use_killers = (_ordering & MOVE_ORDERING_KILLER) != 0;
+
+    const bool use_db = (_ordering & MOVE_ORDERING_DB) != 0 && //
+                        global::use_db();                      //
+
+    vector<scored_move> scored_moves;
+    scored_moves.reserve(moves.size());
+
+    size_t subgame_rank = 0;
+
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        const sumgame_move& sm = moves[i];
+
+        if (i > 0 && sm.subgame_idx != moves[i - 1].subgame_idx)
+            subgame_rank++;
+
+        scored_moves.push_back({sm, MOVE_TIER_OTHER, subgame_rank, 0, {}});
+        scored_move& scored = scored_moves.back();
+
+        if (use_killers && _is_killer(sum, sm, depth))
+            scored.tier = MOVE_TIER_KILLER;
+
+        if (!use_tt && !use_db)
+            continue;
+
+        sum.play_sum(sm, to_play);
+
+        if (use_tt)
+        {
+            ttable_sumgame::search_result sr =
+                sumgame::_tt->search(sum.get_global_hash());
+            stats::report_tt_access(sr.entry_valid());
+
+            // Entry is for the opponent, who plays next
+            if (sumgame::_ttable_entry_solved(sr))
+                scored.tier = sr.get_bool(TTABLE_SUMGAME_WIN)
+                                  ? MOVE_TIER_KNOWN_LOSS
+                                  : MOVE_TIER_KNOWN_WIN;
+        }
+
+        if (use_db)
+        {
+            const play_record& record = sum._play_record_stack.back();
+
+            if (record.split_g)
+            {
+                for (const game* g : record.new_games)
+                    add_db_score(*g, to_play, scored);
+            }
+            else if (!record.deactivated_g)
+                add_db_score(*sum.subgame_const(sm.subgame_idx), to_play,
+                             scored);
+            else
+                scored.outcome_score += ENDED_SUBGAME_SCORE;
+        }
+
+        sum.undo_move();
+    }
+
+    stable_sort(scored_moves.begin(), scored_moves.end());
+
+    for (size_t i = 0; i < moves.size(); i++)
+        moves[i] = scored_moves[i].sm;
+}
+
+void sumgame_move_orderer::add_killer(const sumgame& sum,
+                                      const sumgame_move& sm, uint64_t depth)
+{
+    if ((_ordering & MOVE_ORDERING_KILLER) == 0)
+        return;
+
+    if (_killers.size() <= depth)
+        _killers.resize(depth + 1);
+
+    const killer_move killer = {
+        sum.subgame_const(sm.subgame_idx)->get_local_hash(),
+        sm.m,
+    };
+
+    killer_slots_t& slots = _killers[depth];
+
+    if (slots[0].has_value() &&                          //
+        slots[0]->subgame_hash == killer.subgame_hash && //
+        slots[0]->m == killer.m)                         //
+        return;
+
+    slots[1] = slots[0];
+    slots[0] = killer;
+}
+
+bool sumgame_move_orderer::_is_killer(const sumgame& sum,
+                                      const sumgame_move& sm,
+                                      uint64_t depth) const
+{
+    if (_killers.size() <= depth)
+        return false;
+
+    const hash_t subgame_hash =
+        sum.subgame_const(sm.subgame_idx)->get_local_hash();
+
+    for (const optional<killer_move>& killer : _killers[depth])
+    {
+        if (killer.has_value() &&                   //
+            killer->subgame_hash == subgame_hash && //
+            killer->m == sm.m)                      //
+            return true;
+    }
+
+    return false;
+}
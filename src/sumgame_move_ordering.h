@@ -0,0 +1,100 @@
+/*
+    Move ordering for sumgame::_solve_impl()
+
+    sumgame_move_generator orders subgames by temperature, but moves within a
+    subgame come in the order of the game's own move generator.
+    sumgame_move_orderer reorders the generated moves of a search node using
+    any combination of these heuristics, selected by global::move_ordering
+    ("--move-ordering"):
+
+    MOVE_ORDERING_TT: the resulting position is in sumgame's ttable. Known
+        wins for the player to move go first, and known losses go last.
+        Positions are probed before simplification, so this only finds
+        positions which the simplification passes don't change.
+
+    MOVE_ORDERING_KILLER: moves which won at the same depth elsewhere in the
+        search go next. A killer is a move in a subgame with the same local
+        hash.
+
+    MOVE_ORDERING_DB: remaining moves of each subgame are ranked by the DB
+        outcome classes of the subgames they result in (good outcomes for the
+        player to move first), then by the temperatures of those subgames
+        (coolest first). Subgames stay in sumgame_move_generator's order.
+
+    TT and DB heuristics play and undo each move of the node once.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "cgt_move.h"
+#include "hashing.h"
+#include "sumgame.h"
+
+enum move_ordering_heuristic
+{
+    MOVE_ORDERING_TT = 1,
+    MOVE_ORDERING_KILLER = 2,
+    MOVE_ORDERING_DB = 4,
+};
+
+// Bitwise OR of move_ordering_heuristic values. 0 means no ordering
+typedef unsigned int move_ordering_t;
+
+constexpr move_ordering_t MOVE_ORDERING_NONE = 0;
+constexpr move_ordering_t MOVE_ORDERING_ALL =
+    MOVE_ORDERING_TT | MOVE_ORDERING_KILLER | MOVE_ORDERING_DB;
+
+// i.e. "none", "tt", "killer,db", "tt,killer,db"
+std::string move_ordering_to_string(move_ordering_t ordering);
+
+// Accepts "none", "all", or a comma separated list of "tt", "killer", "db"
+std::optional<move_ordering_t> move_ordering_from_string(
+    const std::string& str);
+
+// From global::move_ordering
+move_ordering_t get_global_move_ordering();
+
+////////////////////////////////////////////////// class sumgame_move_orderer
+class sumgame_move_orderer
+{
+public:
+    sumgame_move_orderer(move_ordering_t ordering);
+
+    move_ordering_t get_ordering() const;
+
+    // Reorder the moves of sum's search node at depth. Restores sum
+    void order_moves(sumgame& sum, bw to_play, uint64_t depth,
+                     std::vector<sumgame_move>& moves);
+
+    // sm won for the player to move in sum, at depth
+    void add_killer(const sumgame& sum, const sumgame_move& sm,
+                    uint64_t depth);
+
+private:
+    struct killer_move
+    {
+        hash_t subgame_hash;
+        ::move m;
+    };
+
+    // Most recent first
+    typedef std::array<std::optional<killer_move>, 2> killer_slots_t;
+
+    bool _is_killer(const sumgame& sum, const sumgame_move& sm,
+                    uint64_t depth) const;
+
+    const move_ordering_t _ordering;
+    std::vector<killer_slots_t> _killers; // indexed by depth
+};
+
+////////////////////////////////////////////////// sumgame_move_orderer methods
+inline move_ordering_t sumgame_move_orderer::get_ordering() const
+{
+    return _ordering;
+}
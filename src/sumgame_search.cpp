@@ -0,0 +1,92 @@
+#include "sumgame_search.h"
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "global_options.h"
+#include "search_graph_debug.h"
+#include "solver_stats.h"
+#include "sumgame.h"
+#include "sumgame_dfpn.h"
+#include "throw_assert.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// sumgame_search_algorithm
+const char* sumgame_search_algorithm_to_string(
+    sumgame_search_algorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case SUMGAME_SEARCH_MINIMAX:
+            return "minimax";
+        case SUMGAME_SEARCH_DFPN:
+            return "dfpn";
+    }
+
+    assert(false);
+    return "";
+}
+
+optional<sumgame_search_algorithm> sumgame_search_algorithm_from_string(
+    const string& str)
+{
+    for (sumgame_search_algorithm algorithm :
+         {SUMGAME_SEARCH_MINIMAX, SUMGAME_SEARCH_DFPN})
+    {
+        if (str == sumgame_search_algorithm_to_string(algorithm))
+            return algorithm;
+    }
+
+    return {};
+}
+
+sumgame_search_algorithm get_global_search_algorithm()
+{
+    optional<sumgame_search_algorithm> algorithm =
+        sumgame_search_algorithm_from_string(global::search_algorithm());
+
+    THROW_ASSERT(algorithm.has_value(), "Invalid search algorithm \"" +
+                                            global::search_algorithm() +
+                                            "\"");
+
+    return algorithm.value();
+}
+
+////////////////////////////////////////////////// minimax_search
+optional<solve_result> minimax_search::solve(sumgame& sum, uint64_t depth)
+{
+#ifndef __EMSCRIPTEN__
+    // Workers don't have depth limits
+    const bool root_split =
+        (global::threads() > 1) &&                     //
+        (depth == INITIAL_SEARCH_DEPTH) &&              //
+        (sum._depth_limit == SUMGAME_NO_DEPTH_LIMIT) && //
+        !sgraph::is_recording();                        //
+
+    if (root_split)
+        return sum._solve_root_split(depth);
+#endif
+
+    return sum._solve_impl(depth);
+}
+
+//////////////////////////////////////////////////
+i_sumgame_search& get_sumgame_search(sumgame_search_algorithm algorithm)
+{
+    static minimax_search minimax;
+    static dfpn_search dfpn;
+
+    switch (algorithm)
+    {
+        case SUMGAME_SEARCH_MINIMAX:
+            return minimax;
+        case SUMGAME_SEARCH_DFPN:
+            return dfpn;
+    }
+
+    assert(false);
+    return minimax;
+}
@@ -0,0 +1,66 @@
+/*
+    Search algorithms used to solve sumgames
+
+    sumgame::solve_with_timeout_token() sets up the sum (pre-solve pass,
+    timeout token, SEG replacer), then hands it to the i_sumgame_search
+    selected by global::search_algorithm ("--search-algorithm").
+
+    SUMGAME_SEARCH_MINIMAX: boolean minimax, sumgame::_solve_impl(), or
+        sumgame::_solve_root_split() when using several threads
+
+    SUMGAME_SEARCH_DFPN: depth-first proof-number search (see sumgame_dfpn.h)
+
+    Search graph recording (see search_graph_debug.h) and depth limited
+    searches (see sumgame::solve_with_depth_limit()) always use minimax,
+    without splitting the root.
+*/
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "sumgame.h"
+
+enum sumgame_search_algorithm
+{
+    SUMGAME_SEARCH_MINIMAX = 0,
+    SUMGAME_SEARCH_DFPN,
+};
+
+// i.e. "minimax", "dfpn"
+const char* sumgame_search_algorithm_to_string(
+    sumgame_search_algorithm algorithm);
+
+std::optional<sumgame_search_algorithm> sumgame_search_algorithm_from_string(
+    const std::string& str);
+
+// From global::search_algorithm
+sumgame_search_algorithm get_global_search_algorithm();
+
+////////////////////////////////////////////////// class i_sumgame_search
+class i_sumgame_search
+{
+public:
+    virtual ~i_sumgame_search() {}
+
+    /*
+        Solve sum for its player to move. Returns no value on timeout (see
+        sumgame::_over_time()). The sum must be restored before returning
+    */
+    virtual std::optional<solve_result> solve(sumgame& sum,
+                                              uint64_t depth) = 0;
+
+    // Clear ttables owned by this search (not sumgame's ttable)
+    virtual void clear_ttable() {}
+};
+
+////////////////////////////////////////////////// class minimax_search
+class minimax_search : public i_sumgame_search
+{
+public:
+    std::optional<solve_result> solve(sumgame& sum, uint64_t depth) override;
+};
+
+// Lives for the whole program
+i_sumgame_search& get_sumgame_search(sumgame_search_algorithm algorithm);
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <cassert>
+#include <cstdint>
 #include <memory>
 
 #include "SgBlackWhite.h"
@@ -24,6 +25,7 @@
 #include "search_graph_debug.h"
 #include "solver_stats.h"
 #include "stopwatch.h"
+#include "sumgame_iterative_deepening.h"
 #include "test_case_enums.h"
 #include "thermograph_builder_no_db.h"
 #include "throw_assert.h"
@@ -71,6 +73,11 @@ void i_test_case::run(unsigned long long timeout)
     stats::reset_global_stats();
     _run_impl(timeout);
 
+    // The search is over, so no DB entry pointers are held
+    if (global::use_db())
+        get_global_database().enforce_memory_budget(
+            uint64_t(global::db_memory_budget()) << 20);
+
     THROW_ASSERT(_csv_row.has_visitor_fields() &&  //
            _csv_row.has_pre_test_fields() && //
            _csv_row.has_post_test_fields()   //
@@ -143,15 +150,27 @@ void test_case_solve_bw::_run_impl(unsigned long long timeout)
 
     sw.start();
     s.add(_games);
-    optional<solve_result> result = s.solve_with_timeout(timeout);
+
+    optional<bool> win;
+
+    if (global::iterative_deepening())
+        win = solve_iterative_deepening(s, timeout).win;
+    else
+    {
+        const optional<solve_result> result = s.solve_with_timeout(timeout);
+
+        if (result.has_value())
+            win = result->win;
+    }
+
     s.pop(_games);
     sw.stop();
 
-    sgraph::end(result.has_value());
+    sgraph::end(win.has_value());
 
     optional<string> result_string;
-    if (result.has_value())
-        result_string = result->win ? "Win" : "Loss";
+    if (win.has_value())
+        result_string = *win ? "Win" : "Loss";
 
     _csv_row.fill_post_test_fields(result_string, sw.get_duration_ms());
 }
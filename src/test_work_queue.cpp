@@ -0,0 +1,147 @@
+#include "test_work_queue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+#include "throw_assert.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// test_work_queue methods
+test_work_queue::test_work_queue(void* ranges, size_t n_workers,
+                                 size_t n_items)
+    : _ranges(static_cast<range_t*>(ranges)), _n_workers(n_workers)
+{
+    THROW_ASSERT(n_workers > 0);
+    THROW_ASSERT(n_items <= UINT32_MAX);
+
+    size_t begin = 0;
+
+    for (size_t i = 0; i < n_workers; i++)
+    {
+        const size_t end = begin + initial_range_size(i, n_workers, n_items);
+        new (&_ranges[i]) range_t(_pack(begin, end));
+        begin = end;
+    }
+
+    assert(begin == n_items);
+}
+
+optional<size_t> test_work_queue::pop(size_t worker_idx)
+{
+    assert(worker_idx < _n_workers);
+    range_t& own = _ranges[worker_idx];
+
+    while (true)
+    {
+        uint64_t range = own.load();
+        const uint32_t begin = _begin(range);
+        const uint32_t end = _end(range);
+
+        if (begin < end)
+        {
+            // Thieves may shrink the range at the same time
+            if (own.compare_exchange_weak(range, _pack(begin + 1, end)))
+                return begin;
+
+            continue;
+        }
+
+        if (!_steal(worker_idx))
+            return {};
+    }
+}
+
+size_t test_work_queue::initial_range_size(size_t worker_idx,
+                                           size_t n_workers, size_t n_items)
+{
+    assert(worker_idx < n_workers);
+    return n_items / n_workers + (worker_idx < n_items % n_workers ? 1 : 0);
+}
+
+bool test_work_queue::_steal(size_t worker_idx)
+{
+    while (true)
+    {
+        size_t victim_idx = _n_workers;
+        uint64_t victim_range = 0;
+        uint32_t victim_size = 0;
+
+        for (size_t i = 0; i < _n_workers; i++)
+        {
+            if (i == worker_idx)
+                continue;
+
+            const uint64_t range = _ranges[i].load();
+            const uint32_t begin = _begin(range);
+            const uint32_t end = _end(range);
+
+            if (begin < end && end - begin > victim_size)
+            {
+                victim_idx = i;
+                victim_range = range;
+                victim_size = end - begin;
+            }
+        }
+
+        if (victim_idx == _n_workers)
+            return false;
+
+        // Take the back half, rounded up
+        const uint32_t begin = _begin(victim_range);
+        const uint32_t end = _end(victim_range);
+        const uint32_t split = end - (victim_size + 1) / 2;
+
+        if (!_ranges[victim_idx].compare_exchange_strong(victim_range,
+                                                         _pack(begin, split)))
+            continue;
+
+        /*
+            Only this worker makes its own range non-empty, and nobody else
+            takes from an empty range, so a plain store is safe
+        */
+        _ranges[worker_idx].store(_pack(split, end));
+        return true;
+    }
+}
+
+//////////////////////////////////////////////////
+vector<size_t> make_test_schedule(const vector<uint64_t>& difficulties,
+                                  size_t n_workers)
+{
+    THROW_ASSERT(n_workers > 0);
+
+    const size_t n_items = difficulties.size();
+
+    // Hardest first
+    vector<size_t> order(n_items);
+    iota(order.begin(), order.end(), 0);
+
+    stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return difficulties[lhs] > difficulties[rhs];
+    });
+
+    // Deal round-robin, into consecutive ranges
+    vector<size_t> schedule(n_items);
+    size_t range_begin = 0;
+
+    for (size_t i = 0; i < n_workers; i++)
+    {
+        const size_t range_size =
+            test_work_queue::initial_range_size(i, n_workers, n_items);
+
+        for (size_t j = 0; j < range_size; j++)
+            schedule[range_begin + j] = order[i + j * n_workers];
+
+        range_begin += range_size;
+    }
+
+    assert(range_begin == n_items);
+    return schedule;
+}
@@ -0,0 +1,96 @@
+/*
+    Work-stealing queue for parallel --run-tests (see autotests.h)
+
+    Schedule positions [0, n_items) are split into one contiguous range per
+    worker. A worker takes positions from the front of its own range. When
+    its range is empty, it steals the back half of the largest remaining
+    range, and continues from there.
+
+    Ranges are lock-free atomics in memory given by the caller, so worker
+    processes can share them through a shared memory mapping. Each range is
+    one 64-bit word: begin in the low 32 bits, end in the high 32 bits.
+
+    make_test_schedule() orders items for the queue: hardest items first in
+    each worker's range, dealt round-robin so that ranges have similar work.
+    Stealing from the back then takes the easiest remaining items.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+////////////////////////////////////////////////// class test_work_queue
+class test_work_queue
+{
+public:
+    typedef std::atomic<uint64_t> range_t;
+
+    static_assert(range_t::is_always_lock_free);
+
+    // Bytes of `ranges` memory needed by the constructor
+    static size_t ranges_size(size_t n_workers);
+
+    /*
+        Constructs n_workers ranges in `ranges` (at least ranges_size()
+        bytes), dividing [0, n_items) between them as make_test_schedule()
+        expects. Doesn't take ownership
+    */
+    test_work_queue(void* ranges, size_t n_workers, size_t n_items);
+
+    // Next schedule position for the worker. No value when all are taken
+    std::optional<size_t> pop(size_t worker_idx);
+
+    size_t n_workers() const;
+
+    // Number of positions in the worker's range at construction
+    static size_t initial_range_size(size_t worker_idx, size_t n_workers,
+                                     size_t n_items);
+
+private:
+    static uint64_t _pack(uint32_t begin, uint32_t end);
+    static uint32_t _begin(uint64_t range);
+    static uint32_t _end(uint64_t range);
+
+    // Steal half of the largest other range. false if all are empty
+    bool _steal(size_t worker_idx);
+
+    range_t* _ranges;
+    size_t _n_workers;
+};
+
+/*
+    Schedule of items for a test_work_queue with n_workers: position ->
+    item index. Items with higher difficulty come earlier in each worker's
+    range. Items with equal difficulty keep their order
+*/
+std::vector<size_t> make_test_schedule(
+    const std::vector<uint64_t>& difficulties, size_t n_workers);
+
+////////////////////////////////////////////////// test_work_queue methods
+inline size_t test_work_queue::ranges_size(size_t n_workers)
+{
+    return n_workers * sizeof(range_t);
+}
+
+inline size_t test_work_queue::n_workers() const
+{
+    return _n_workers;
+}
+
+inline uint64_t test_work_queue::_pack(uint32_t begin, uint32_t end)
+{
+    return uint64_t(begin) | (uint64_t(end) << 32);
+}
+
+inline uint32_t test_work_queue::_begin(uint64_t range)
+{
+    return static_cast<uint32_t>(range);
+}
+
+inline uint32_t test_work_queue::_end(uint64_t range)
+{
+    return static_cast<uint32_t>(range >> 32);
+}
@@ -0,0 +1,62 @@
+#include "transposition_concurrent.h"
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <cassert>
+
+#include "global_options.h"
+#include "throw_assert.h"
+
+using namespace std;
+
+////////////////////////////////////////////////// ttable_replacement_policy
+const char* ttable_replacement_policy_to_string(
+    ttable_replacement_policy policy)
+{
+    switch (policy)
+    {
+        case TT_REPLACE_ALWAYS:
+            return "always";
+        case TT_REPLACE_DEPTH:
+            return "depth";
+        case TT_REPLACE_SUBTREE_SIZE:
+            return "subtree";
+        case TT_REPLACE_TWO_TIER:
+            return "two-tier";
+    }
+
+    assert(false);
+    return "";
+}
+
+optional<ttable_replacement_policy> ttable_replacement_policy_from_string(
+    const string& str)
+{
+    for (ttable_replacement_policy policy :
+         {TT_REPLACE_ALWAYS, TT_REPLACE_DEPTH, TT_REPLACE_SUBTREE_SIZE,
+          TT_REPLACE_TWO_TIER})
+    {
+        if (str == ttable_replacement_policy_to_string(policy))
+            return policy;
+    }
+
+    return {};
+}
+
+ttable_replacement_policy get_global_tt_replacement_policy()
+{
+    optional<ttable_replacement_policy> policy =
+        ttable_replacement_policy_from_string(global::tt_replacement());
+
+    THROW_ASSERT(policy.has_value(), "Invalid ttable replacement policy: \"" +
+                                         global::tt_replacement() + "\"");
+    return *policy;
+}
+
+////////////////////////////////////////////////// ttable_store_counts
+void ttable_store_counts::print(ostream& os) const
+{
+    os << "inserts: " << inserts << ", overwrites: " << overwrites
+       << ", evictions: " << evictions << ", rejections: " << rejections;
+}
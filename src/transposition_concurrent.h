@@ -0,0 +1,986 @@
+/*
+    Lock-free transposition table template concurrent_ttable<Entry>
+
+    Can be shared by threads searching in parallel, without locks. Slots are
+    grouped into 64 byte (cache line) buckets, and a hash may be stored in any
+    slot of its bucket, so one probe touches one cache line. Each slot has one
+    or two 64-bit atomic words:
+
+        data: the Entry, copied bytewise (omitted when Entry is empty)
+        key: (tag bits of hash | valid bit | packed bools) XOR data
+
+    The flags (valid bit and packed bools) are stored in the low bits of the
+    key, which are otherwise redundant as they're the bucket's index bits. A
+    reader loads both words, and accepts the slot only if (key XOR data) has
+    the searched hash's tag. A slot torn by two simultaneous writers then
+    reads as a miss, instead of returning another position's data.
+
+    Slots per bucket: 8 when Entry is empty, otherwise 4. The table still has
+    2^index_bits slots, and index_bits must leave room for the flags in the
+    bucket index bits.
+
+    When a hash isn't already in its bucket, it goes into an empty slot if
+    there is one. Otherwise the ttable_replacement_policy decides which entry
+    is evicted, if any (see below). Entries get a priority from the depth and
+    subtree size given to search_result::set_effort(). The priority is stored
+    in the key's remaining bucket index bits (up to 8 bits).
+
+    search_result has the same API as ttable<Entry>::search_result, but
+    works on a copy of the entry taken by search(). Changes made through it
+    are written back to the table (in one store) when it's destroyed, so
+    other threads never see a partially initialized entry. This means two
+    live search_results for the same hash don't see each other's changes.
+
+    save_file() writes the buckets as they are in memory (see
+    transposition_file.h). load_file() either reads them back, or maps the
+    file copy-on-write, so a large table is ready without being read, and
+    processes loading the same file share its pages until they write to them.
+
+    Entry must be trivially copyable, and at most 8 bytes.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "utilities.h"
+#include "hashing.h"
+#include "mapped_file.h"
+#include "throw_assert.h"
+#include "serializer.h"
+#include "transposition_file.h"
+
+////////////////////////////////////////////////// ttable_replacement_policy
+/*
+    What to evict when a new hash is stored into a full bucket:
+
+    TT_REPLACE_ALWAYS: the slot chosen by the hash bits just above the bucket
+        index
+
+    TT_REPLACE_DEPTH: the entry farthest from the root. If the new entry is
+        farther from the root than all entries, it's not stored
+
+    TT_REPLACE_SUBTREE_SIZE: the entry with the smallest search subtree. If
+        the new entry's subtree is smaller than all of them, it's not stored
+
+    TT_REPLACE_TWO_TIER: the first half of the bucket is replaced by subtree
+        size, and entries it evicts move to the second half. Entries not
+        accepted by the first half, and moved entries, go into the second half
+        as in TT_REPLACE_ALWAYS
+*/
+enum ttable_replacement_policy
+{
+    TT_REPLACE_ALWAYS = 0,
+    TT_REPLACE_DEPTH,
+    TT_REPLACE_SUBTREE_SIZE,
+    TT_REPLACE_TWO_TIER,
+};
+
+// i.e. "always", "depth", "subtree", "two-tier"
+const char* ttable_replacement_policy_to_string(
+    ttable_replacement_policy policy);
+
+std::optional<ttable_replacement_policy> ttable_replacement_policy_from_string(
+    const std::string& str);
+
+// From global::tt_replacement
+ttable_replacement_policy get_global_tt_replacement_policy();
+
+// Counts of each kind of store into a concurrent_ttable
+struct ttable_store_counts
+{
+    uint64_t inserts;    // into empty slot
+    uint64_t overwrites; // same hash updated
+    uint64_t evictions;  // other hash removed from table
+    uint64_t rejections; // new entry not stored
+
+    void print(std::ostream& os) const;
+};
+
+////////////////////////////////////////////////// class concurrent_ttable
+template <class Entry>
+class concurrent_ttable
+{
+public:
+    class search_result
+    {
+    public:
+        ~search_result();
+
+        // no copy (changes would be written back twice)
+        search_result(const search_result& rhs) = delete;
+        search_result& operator=(const search_result& rhs) = delete;
+
+        search_result(search_result&& rhs);
+        search_result& operator=(search_result&& rhs) = delete;
+
+        bool entry_valid() const;
+
+        const Entry& get_entry() const;
+
+        void set_entry(const Entry& entry);
+
+        void init_entry();
+        void init_entry(const Entry& entry);
+
+        bool get_bool(size_t bool_idx) const;
+        void set_bool(size_t bool_idx, bool new_val);
+
+        /*
+            Search depth of this position, and the number of search nodes it
+            took to solve it. Used by the table's replacement policy
+        */
+        void set_effort(uint64_t depth, uint64_t subtree_size);
+
+    private:
+        search_result() = delete;
+        search_result(concurrent_ttable<Entry>& table, hash_t hash);
+
+        concurrent_ttable<Entry>* _table;
+        const hash_t _hash;
+
+        uint64_t _flags; // valid bit and packed bools
+        Entry _entry;
+        uint64_t _priority;
+        bool _modified;
+
+        friend concurrent_ttable<Entry>;
+    };
+
+    concurrent_ttable(size_t index_bits, size_t entry_bools,
+                      ttable_replacement_policy policy = TT_REPLACE_ALWAYS);
+
+    // no copy
+    concurrent_ttable(const concurrent_ttable& rhs) = delete;
+    concurrent_ttable& operator=(const concurrent_ttable& rhs) = delete;
+
+    concurrent_ttable(concurrent_ttable&& rhs);
+    concurrent_ttable& operator=(concurrent_ttable&& rhs);
+
+    search_result search(hash_t hash);
+
+    void store(hash_t hash, const Entry& entry);
+    std::optional<Entry> get(hash_t hash) const;
+
+    // Not thread safe
+    void clear();
+
+    bool operator==(const concurrent_ttable& rhs) const;
+    bool operator!=(const concurrent_ttable& rhs) const;
+
+    size_t n_index_bits() const;
+    size_t n_entry_bools() const;
+
+    ttable_replacement_policy get_replacement_policy() const;
+    void set_replacement_policy(ttable_replacement_policy policy);
+
+    // Since construction. Not reset by clear()
+    ttable_store_counts get_store_counts() const;
+
+    uint64_t get_size_estimate() const;
+    void print_size_estimate(std::ostream& os) const;
+
+    // Not thread safe
+    void save_file(const std::string& file_name, ttable_file_kind kind) const;
+
+    /*
+        Load a table written by save_file(). Throws if the file holds a
+        different kind of table, or its Entry size doesn't match.
+
+        If use_mmap, the file is mapped copy-on-write instead of read (when
+        mapped_file::SUPPORTED). Changes to the table never reach the file
+    */
+    static concurrent_ttable load_file(const std::string& file_name,
+                                       ttable_file_kind kind, bool use_mmap);
+
+    // Buckets are in a mapped file
+    bool is_mapped() const;
+
+private:
+    friend serializer<concurrent_ttable<Entry>>;
+
+    static constexpr bool _ENTRY_EMPTY = std::is_empty_v<Entry>;
+    static constexpr uint64_t _VALID_BIT = 1;
+
+    static_assert(std::is_trivially_copyable_v<Entry>);
+    static_assert(sizeof(Entry) <= sizeof(uint64_t));
+
+    struct slot_with_data
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    struct slot_key_only
+    {
+        std::atomic<uint64_t> key;
+    };
+
+    typedef std::conditional_t<_ENTRY_EMPTY, slot_key_only, slot_with_data>
+        slot;
+
+    static constexpr size_t _MAX_PRIORITY_BITS = 8;
+
+    static constexpr size_t _BUCKET_BYTES = 64;
+    static constexpr size_t _SLOTS_PER_BUCKET = _BUCKET_BYTES / sizeof(slot);
+    static constexpr size_t _SLOT_BITS = (_SLOTS_PER_BUCKET == 8) ? 3 : 2;
+
+    static_assert(size_t(1) << _SLOT_BITS == _SLOTS_PER_BUCKET);
+
+    struct alignas(_BUCKET_BYTES) bucket
+    {
+        slot slots[_SLOTS_PER_BUCKET];
+    };
+
+    static_assert(sizeof(bucket) == _BUCKET_BYTES);
+
+    // Buckets are written to files, and mapped from them, as raw bytes
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+    // Own cache line, as all threads write these
+    struct alignas(_BUCKET_BYTES) atomic_store_counts
+    {
+        std::atomic<uint64_t> inserts;
+        std::atomic<uint64_t> overwrites;
+        std::atomic<uint64_t> evictions;
+        std::atomic<uint64_t> rejections;
+    };
+
+    // Doesn't allocate/initialize anything. used by serializer to avoid
+    // unnecessary allocations
+    concurrent_ttable();
+
+    void _allocate(size_t index_bits, size_t entry_bools);
+    // Sets sizes and resets store counts, but doesn't allocate buckets
+    void _init_layout(size_t index_bits, size_t entry_bools);
+    void _move_impl(concurrent_ttable<Entry>&& rhs);
+
+    inline bucket& _get_bucket(hash_t hash) const;
+    inline hash_t _tag_mask() const;
+
+    /*
+        Read a slot. Returns the slot's key (XORed with data, so the tag and
+        flags can be read directly). data is 0 if Entry is empty
+    */
+    static inline uint64_t _read_slot(const slot& s, uint64_t& data);
+    static inline void _write_slot(slot& s, uint64_t key, uint64_t data);
+
+    // Returns flags, or 0 (invalid) if the bucket doesn't hold this hash
+    uint64_t _load(hash_t hash, Entry& entry) const;
+    void _store(hash_t hash, uint64_t flags, uint64_t priority,
+                const Entry& entry);
+
+    uint64_t _compute_priority(uint64_t depth, uint64_t subtree_size) const;
+    inline uint64_t _get_priority(uint64_t key) const;
+    inline size_t _hash_selected_slot(hash_t hash, size_t n_slots) const;
+
+    // Index of lowest priority slot in [begin, end)
+    size_t _lowest_priority_slot(const bucket& b, size_t begin,
+                                 size_t end) const;
+
+    static uint64_t _entry_to_word(const Entry& entry);
+    static Entry _word_to_entry(uint64_t word);
+
+    size_t _n_index_bits;
+    size_t _n_entries;
+    size_t _n_bucket_bits;
+    size_t _n_buckets;
+    size_t _bools_per_entry; // includes valid bit
+    size_t _n_priority_bits;
+    ttable_replacement_policy _policy;
+
+    // Points into either _owned_buckets or _mapping
+    bucket* _buckets;
+    std::unique_ptr<bucket[]> _owned_buckets;
+    std::unique_ptr<mapped_file> _mapping;
+
+    std::unique_ptr<atomic_store_counts> _store_counts;
+};
+
+////////////////////////////////////////////////// concurrent_ttable<Entry>
+/// implementation
+template <class Entry>
+concurrent_ttable<Entry>::concurrent_ttable(size_t index_bits,
+                                            size_t n_packed_bools,
+                                            ttable_replacement_policy policy)
+    : _policy(policy)
+{
+    _allocate(index_bits, n_packed_bools);
+}
+
+template <class Entry>
+concurrent_ttable<Entry>::concurrent_ttable(concurrent_ttable&& rhs)
+{
+    _move_impl(std::forward<concurrent_ttable<Entry>>(rhs));
+}
+
+template <class Entry>
+concurrent_ttable<Entry>& concurrent_ttable<Entry>::operator=(
+    concurrent_ttable&& rhs)
+{
+    _move_impl(std::forward<concurrent_ttable<Entry>>(rhs));
+    return *this;
+}
+
+template <class Entry>
+typename concurrent_ttable<Entry>::search_result
+concurrent_ttable<Entry>::search(hash_t hash)
+{
+    return search_result(*this, hash);
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::store(hash_t hash, const Entry& entry)
+{
+    // Same restriction as ttable::store(), to avoid accidentally resetting
+    // bools
+    THROW_ASSERT_DEBUG(_bools_per_entry == 1);
+
+    _store(hash, _VALID_BIT, 0, entry);
+}
+
+template <class Entry>
+std::optional<Entry> concurrent_ttable<Entry>::get(hash_t hash) const
+{
+    Entry entry;
+    const uint64_t flags = _load(hash, entry);
+
+    if ((flags & _VALID_BIT) != 0)
+        return std::optional<Entry>(entry);
+
+    return std::optional<Entry>();
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::clear()
+{
+    for (size_t i = 0; i < _n_buckets; i++)
+        for (slot& s : _buckets[i].slots)
+            _write_slot(s, 0, 0);
+}
+
+template <class Entry>
+bool concurrent_ttable<Entry>::operator==(const concurrent_ttable& rhs) const
+{
+    if (_n_index_bits != rhs._n_index_bits)
+        return false;
+    if (_n_entries != rhs._n_entries)
+        return false;
+    if (_bools_per_entry != rhs._bools_per_entry)
+        return false;
+
+    for (size_t i = 0; i < _n_buckets; i++)
+    {
+        for (size_t j = 0; j < _SLOTS_PER_BUCKET; j++)
+        {
+            uint64_t data1;
+            uint64_t data2;
+            const uint64_t key1 = _read_slot(_buckets[i].slots[j], data1);
+            const uint64_t key2 = _read_slot(rhs._buckets[i].slots[j], data2);
+
+            if (key1 != key2 || data1 != data2)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+template <class Entry>
+bool concurrent_ttable<Entry>::operator!=(const concurrent_ttable& rhs) const
+{
+    return !(*this == rhs);
+}
+
+template <class Entry>
+inline size_t concurrent_ttable<Entry>::n_index_bits() const
+{
+    return _n_index_bits;
+}
+
+template <class Entry>
+inline size_t concurrent_ttable<Entry>::n_entry_bools() const
+{
+    assert(_bools_per_entry > 0);
+    return _bools_per_entry - 1; // -1 due to valid bit
+}
+
+template <class Entry>
+inline ttable_replacement_policy
+concurrent_ttable<Entry>::get_replacement_policy() const
+{
+    return _policy;
+}
+
+template <class Entry>
+inline void concurrent_ttable<Entry>::set_replacement_policy(
+    ttable_replacement_policy policy)
+{
+    _policy = policy;
+}
+
+template <class Entry>
+ttable_store_counts concurrent_ttable<Entry>::get_store_counts() const
+{
+    ttable_store_counts counts;
+
+    counts.inserts = _store_counts->inserts.load(std::memory_order_relaxed);
+    counts.overwrites =
+        _store_counts->overwrites.load(std::memory_order_relaxed);
+    counts.evictions = _store_counts->evictions.load(std::memory_order_relaxed);
+    counts.rejections =
+        _store_counts->rejections.load(std::memory_order_relaxed);
+
+    return counts;
+}
+
+template <class Entry>
+inline uint64_t concurrent_ttable<Entry>::get_size_estimate() const
+{
+    return _n_buckets * sizeof(bucket);
+}
+
+template <class Entry>
+inline void concurrent_ttable<Entry>::print_size_estimate(
+    std::ostream& os) const
+{
+    const uint64_t byte_count = get_size_estimate();
+    const double byte_count_formatted =
+        ((double) byte_count) / (1024.0 * 1024.0);
+
+    os << byte_count_formatted << " MiB";
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::save_file(const std::string& file_name,
+                                         ttable_file_kind kind) const
+{
+    ttable_file_header header = make_ttable_file_header();
+
+    header.kind = kind;
+    header.slot_bytes = sizeof(slot);
+    header.entry_bytes = _ENTRY_EMPTY ? 0 : sizeof(Entry);
+    header.index_bits = _n_index_bits;
+    header.bools_per_entry = _bools_per_entry;
+
+    write_ttable_file(file_name, header, _buckets,
+                      _n_buckets * sizeof(bucket));
+}
+
+template <class Entry>
+concurrent_ttable<Entry> concurrent_ttable<Entry>::load_file(
+    const std::string& file_name, ttable_file_kind kind, bool use_mmap)
+{
+    const ttable_file_header header = read_ttable_file_header(file_name);
+    const std::string error_prefix = "ttable file \"" + file_name + "\" ";
+
+    THROW_ASSERT(header.kind == static_cast<uint64_t>(kind),
+                 error_prefix + "holds a different kind of ttable!");
+
+    THROW_ASSERT(header.slot_bytes == sizeof(slot) &&
+                     header.entry_bytes == (_ENTRY_EMPTY ? 0 : sizeof(Entry)),
+                 error_prefix + "has different entry size!");
+
+    THROW_ASSERT(header.bools_per_entry > 0 &&
+                     header.index_bits < size_in_bits<hash_t>() &&
+                     header.index_bits < size_in_bits<size_t>(),
+                 error_prefix + "has invalid header!");
+
+    concurrent_ttable<Entry> tt;
+    tt._init_layout(header.index_bits, header.bools_per_entry - 1);
+
+    const size_t n_bytes = tt._n_buckets * sizeof(bucket);
+
+    if (use_mmap && mapped_file::SUPPORTED)
+    {
+        tt._mapping.reset(
+            new mapped_file(file_name, MAPPED_FILE_COPY_ON_WRITE));
+
+        THROW_ASSERT(tt._mapping->size() == sizeof(header) + n_bytes,
+                     error_prefix + "has wrong size!");
+
+        // Header is 64 bytes, and the mapping is page aligned
+        tt._buckets =
+            reinterpret_cast<bucket*>(tt._mapping->data() + sizeof(header));
+    }
+    else
+    {
+        tt._owned_buckets.reset(new bucket[tt._n_buckets]);
+        tt._buckets = tt._owned_buckets.get();
+
+        read_ttable_file_data(file_name, tt._buckets, n_bytes);
+    }
+
+    return tt;
+}
+
+template <class Entry>
+inline bool concurrent_ttable<Entry>::is_mapped() const
+{
+    return _mapping.get() != nullptr;
+}
+
+// private constructor
+template <class Entry>
+concurrent_ttable<Entry>::concurrent_ttable()
+    : _n_index_bits(0),
+      _n_entries(0),
+      _n_bucket_bits(0),
+      _n_buckets(0),
+      _bools_per_entry(0),
+      _n_priority_bits(0),
+      _policy(TT_REPLACE_ALWAYS),
+      _buckets(nullptr)
+{
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::_allocate(size_t index_bits,
+                                         size_t n_packed_bools)
+{
+    _init_layout(index_bits, n_packed_bools);
+
+    _mapping.reset();
+    _owned_buckets.reset(new bucket[_n_buckets]);
+    _buckets = _owned_buckets.get();
+    clear();
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::_init_layout(size_t index_bits,
+                                            size_t n_packed_bools)
+{
+    // avoid shifting entire width of hash_t or size_t
+    assert(index_bits < size_in_bits<hash_t>() &&
+           index_bits < size_in_bits<size_t>());
+
+    THROW_ASSERT(index_bits >= _SLOT_BITS,
+                 "concurrent_ttable needs at least one full bucket!");
+
+    _n_index_bits = index_bits;
+    _n_entries = size_t(1) << index_bits;
+    _n_bucket_bits = index_bits - _SLOT_BITS;
+    _n_buckets = size_t(1) << _n_bucket_bits;
+    _bools_per_entry = 1 + n_packed_bools; // +1 for valid bit
+
+    // Flags are stored in the bucket index bits of the key
+    THROW_ASSERT(_bools_per_entry <= _n_bucket_bits,
+                 "concurrent_ttable has too many packed bools!");
+
+    // Priority goes in the remaining bucket index bits
+    _n_priority_bits =
+        std::min(_MAX_PRIORITY_BITS, _n_bucket_bits - _bools_per_entry);
+
+    THROW_ASSERT(_n_buckets <= (SIZE_MAX / sizeof(bucket)),
+                 "concurrent_ttable too large!");
+
+    _store_counts.reset(new atomic_store_counts());
+    _store_counts->inserts.store(0, std::memory_order_relaxed);
+    _store_counts->overwrites.store(0, std::memory_order_relaxed);
+    _store_counts->evictions.store(0, std::memory_order_relaxed);
+    _store_counts->rejections.store(0, std::memory_order_relaxed);
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::_move_impl(concurrent_ttable<Entry>&& rhs)
+{
+    _n_index_bits = rhs._n_index_bits;
+    _n_entries = rhs._n_entries;
+    _n_bucket_bits = rhs._n_bucket_bits;
+    _n_buckets = rhs._n_buckets;
+    _bools_per_entry = rhs._bools_per_entry;
+    _n_priority_bits = rhs._n_priority_bits;
+    _policy = rhs._policy;
+    _buckets = rhs._buckets;
+    _owned_buckets = std::move(rhs._owned_buckets);
+    _mapping = std::move(rhs._mapping);
+    rhs._buckets = nullptr;
+    _store_counts = std::move(rhs._store_counts);
+}
+
+template <class Entry>
+inline typename concurrent_ttable<Entry>::bucket&
+concurrent_ttable<Entry>::_get_bucket(hash_t hash) const
+{
+    return _buckets[hash & get_bit_mask_lower<hash_t>(_n_bucket_bits)];
+}
+
+template <class Entry>
+inline hash_t concurrent_ttable<Entry>::_tag_mask() const
+{
+    return ~get_bit_mask_lower<hash_t>(_n_bucket_bits);
+}
+
+template <class Entry>
+inline uint64_t concurrent_ttable<Entry>::_read_slot(const slot& s,
+                                                     uint64_t& data)
+{
+    if constexpr (_ENTRY_EMPTY)
+    {
+        data = 0;
+        return s.key.load(std::memory_order_relaxed);
+    }
+    else
+    {
+        data = s.data.load(std::memory_order_relaxed);
+        return s.key.load(std::memory_order_relaxed) ^ data;
+    }
+}
+
+template <class Entry>
+inline void concurrent_ttable<Entry>::_write_slot(slot& s, uint64_t key,
+                                                  uint64_t data)
+{
+    if constexpr (_ENTRY_EMPTY)
+    {
+        assert(data == 0);
+        s.key.store(key, std::memory_order_relaxed);
+    }
+    else
+    {
+        s.data.store(data, std::memory_order_relaxed);
+        s.key.store(key ^ data, std::memory_order_relaxed);
+    }
+}
+
+template <class Entry>
+uint64_t concurrent_ttable<Entry>::_load(hash_t hash, Entry& entry) const
+{
+    const bucket& b = _get_bucket(hash);
+    const hash_t tag_mask = _tag_mask();
+    const hash_t tag = hash & tag_mask;
+
+    for (const slot& s : b.slots)
+    {
+        uint64_t data;
+        const uint64_t key = _read_slot(s, data);
+
+        if ((key & tag_mask) == tag && (key & _VALID_BIT) != 0)
+        {
+            entry = _word_to_entry(data);
+            return key & get_bit_mask_lower<uint64_t>(_bools_per_entry);
+        }
+    }
+
+    return 0;
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::_store(hash_t hash, uint64_t flags,
+                                      uint64_t priority, const Entry& entry)
+{
+    const hash_t tag_mask = _tag_mask();
+    const hash_t tag = hash & tag_mask;
+
+    assert((flags & _VALID_BIT) != 0);
+    assert((flags >> _bools_per_entry) == 0);
+    assert((priority >> _n_priority_bits) == 0);
+
+    const uint64_t new_key = tag | (priority << _bools_per_entry) | flags;
+    const uint64_t new_data = _entry_to_word(entry);
+
+    bucket& b = _get_bucket(hash);
+    atomic_store_counts& counts = *_store_counts;
+
+    // Same hash, then empty slot
+    slot* empty_slot = nullptr;
+
+    for (slot& s : b.slots)
+    {
+        uint64_t data;
+        const uint64_t key = _read_slot(s, data);
+
+        if ((key & _VALID_BIT) == 0)
+        {
+            if (empty_slot == nullptr)
+                empty_slot = &s;
+            continue;
+        }
+
+        if ((key & tag_mask) == tag)
+        {
+            _write_slot(s, new_key, new_data);
+            counts.overwrites.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    if (empty_slot != nullptr)
+    {
+        _write_slot(*empty_slot, new_key, new_data);
+        counts.inserts.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Bucket is full
+    switch (_policy)
+    {
+        case TT_REPLACE_ALWAYS:
+        {
+            const size_t slot_idx =
+                _hash_selected_slot(hash, _SLOTS_PER_BUCKET);
+            _write_slot(b.slots[slot_idx], new_key, new_data);
+            break;
+        }
+
+        case TT_REPLACE_DEPTH:
+        case TT_REPLACE_SUBTREE_SIZE:
+        {
+            const size_t slot_idx =
+                _lowest_priority_slot(b, 0, _SLOTS_PER_BUCKET);
+            slot& victim = b.slots[slot_idx];
+
+            uint64_t data;
+            if (priority < _get_priority(_read_slot(victim, data)))
+            {
+                counts.rejections.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            _write_slot(victim, new_key, new_data);
+            break;
+        }
+
+        case TT_REPLACE_TWO_TIER:
+        {
+            constexpr size_t TIER_SIZE = _SLOTS_PER_BUCKET / 2;
+
+            const size_t preferred_idx = _lowest_priority_slot(b, 0, TIER_SIZE);
+            slot& preferred = b.slots[preferred_idx];
+            slot& second_tier =
+                b.slots[TIER_SIZE + _hash_selected_slot(hash, TIER_SIZE)];
+
+            uint64_t old_data;
+            const uint64_t old_key = _read_slot(preferred, old_data);
+
+            if (priority < _get_priority(old_key))
+            {
+                _write_slot(second_tier, new_key, new_data);
+                break;
+            }
+
+            // Move old entry to second tier
+            _write_slot(second_tier, old_key, old_data);
+            _write_slot(preferred, new_key, new_data);
+            break;
+        }
+    }
+
+    counts.evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class Entry>
+uint64_t concurrent_ttable<Entry>::_compute_priority(
+    uint64_t depth, uint64_t subtree_size) const
+{
+    const uint64_t max_priority =
+        get_bit_mask_lower<uint64_t>(_n_priority_bits);
+
+    switch (_policy)
+    {
+        case TT_REPLACE_ALWAYS:
+            return 0;
+
+        case TT_REPLACE_DEPTH:
+            return max_priority - std::min(depth, max_priority);
+
+        case TT_REPLACE_SUBTREE_SIZE:
+        case TT_REPLACE_TWO_TIER:
+        {
+            // log2 of subtree size
+            uint64_t priority = 0;
+            while (subtree_size > 1 && priority < max_priority)
+            {
+                subtree_size >>= 1;
+                priority++;
+            }
+
+            return priority;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+template <class Entry>
+inline uint64_t concurrent_ttable<Entry>::_get_priority(uint64_t key) const
+{
+    return (key >> _bools_per_entry) &
+           get_bit_mask_lower<uint64_t>(_n_priority_bits);
+}
+
+template <class Entry>
+inline size_t concurrent_ttable<Entry>::_hash_selected_slot(
+    hash_t hash, size_t n_slots) const
+{
+    assert(is_power_of_2(n_slots));
+    return (hash >> _n_bucket_bits) & (n_slots - 1);
+}
+
+template <class Entry>
+size_t concurrent_ttable<Entry>::_lowest_priority_slot(const bucket& b,
+                                                       size_t begin,
+                                                       size_t end) const
+{
+    assert(begin < end && end <= _SLOTS_PER_BUCKET);
+
+    size_t lowest_idx = begin;
+    uint64_t lowest_priority = UINT64_MAX;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        uint64_t data;
+        const uint64_t priority = _get_priority(_read_slot(b.slots[i], data));
+
+        if (priority < lowest_priority)
+        {
+            lowest_idx = i;
+            lowest_priority = priority;
+        }
+    }
+
+    return lowest_idx;
+}
+
+template <class Entry>
+inline uint64_t concurrent_ttable<Entry>::_entry_to_word(const Entry& entry)
+{
+    uint64_t word = 0;
+
+    if constexpr (!_ENTRY_EMPTY)
+        std::memcpy(&word, &entry, sizeof(Entry));
+
+    return word;
+}
+
+template <class Entry>
+inline Entry concurrent_ttable<Entry>::_word_to_entry(uint64_t word)
+{
+    Entry entry;
+
+    if constexpr (!_ENTRY_EMPTY)
+        std::memcpy(static_cast<void*>(&entry), &word, sizeof(Entry));
+
+    return entry;
+}
+
+////////////////////////////////////////////////// concurrent_ttable<Entry>::
+/// search_result implementation
+template <class Entry>
+concurrent_ttable<Entry>::search_result::search_result(
+    concurrent_ttable<Entry>& table, hash_t hash)
+    : _table(&table),
+      _hash(hash),
+      _flags(0),
+      _entry(),
+      _priority(0),
+      _modified(false)
+{
+    _flags = _table->_load(_hash, _entry);
+}
+
+template <class Entry>
+concurrent_ttable<Entry>::search_result::search_result(search_result&& rhs)
+    : _table(rhs._table),
+      _hash(rhs._hash),
+      _flags(rhs._flags),
+      _entry(rhs._entry),
+      _priority(rhs._priority),
+      _modified(rhs._modified)
+{
+    rhs._modified = false;
+}
+
+template <class Entry>
+concurrent_ttable<Entry>::search_result::~search_result()
+{
+    if (_modified)
+        _table->_store(_hash, _flags, _priority, _entry);
+}
+
+template <class Entry>
+bool concurrent_ttable<Entry>::search_result::entry_valid() const
+{
+    return (_flags & _VALID_BIT) != 0;
+}
+
+template <class Entry>
+const Entry& concurrent_ttable<Entry>::search_result::get_entry() const
+{
+    THROW_ASSERT_DEBUG(entry_valid());
+    return _entry;
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::search_result::set_entry(const Entry& entry)
+{
+    if (!entry_valid())
+    {
+        init_entry(entry);
+        return;
+    }
+
+    _entry = entry;
+    _modified = true;
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::search_result::init_entry()
+{
+    init_entry(Entry());
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::search_result::init_entry(const Entry& entry)
+{
+    _flags = _VALID_BIT;
+    _entry = entry;
+    _modified = true;
+}
+
+template <class Entry>
+bool concurrent_ttable<Entry>::search_result::get_bool(size_t bool_idx) const
+{
+    THROW_ASSERT_DEBUG(entry_valid());
+    THROW_ASSERT_DEBUG(bool_idx + 1 < _table->_bools_per_entry);
+
+    // +1 because index 0 is valid bit
+    return (_flags >> (bool_idx + 1)) & 0x1;
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::search_result::set_bool(size_t bool_idx,
+                                                       bool new_val)
+{
+    THROW_ASSERT_DEBUG(entry_valid());
+    THROW_ASSERT_DEBUG(bool_idx + 1 < _table->_bools_per_entry);
+
+    // +1 because index 0 is valid bit
+    const uint64_t bit_mask = uint64_t(1) << (bool_idx + 1);
+
+    if (new_val)
+        _flags |= bit_mask;
+    else
+        _flags &= ~bit_mask;
+
+    _modified = true;
+}
+
+template <class Entry>
+void concurrent_ttable<Entry>::search_result::set_effort(uint64_t depth,
+                                                         uint64_t subtree_size)
+{
+    _priority = _table->_compute_priority(depth, subtree_size);
+}
@@ -0,0 +1,132 @@
+#include "transposition_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "throw_assert.h"
+
+using namespace std;
+
+namespace {
+constexpr char TTABLE_FILE_MAGIC[8] = {'M', 'C', 'G', 'S', 'T', 'T', 'B', 'L'};
+constexpr uint64_t TTABLE_FILE_BYTE_ORDER = 0x0102030405060708ull;
+constexpr uint64_t TTABLE_FILE_VERSION = 1;
+
+// fread/fwrite may transfer less than asked for large sizes
+bool read_all(FILE* file, void* dst, size_t n_bytes)
+{
+    uint8_t* ptr = static_cast<uint8_t*>(dst);
+
+    while (n_bytes > 0)
+    {
+        const size_t n_read = fread(ptr, 1, n_bytes, file);
+        if (n_read == 0)
+            return false;
+
+        ptr += n_read;
+        n_bytes -= n_read;
+    }
+
+    return true;
+}
+
+bool write_all(FILE* file, const void* src, size_t n_bytes)
+{
+    const uint8_t* ptr = static_cast<const uint8_t*>(src);
+
+    while (n_bytes > 0)
+    {
+        const size_t n_written = fwrite(ptr, 1, n_bytes, file);
+        if (n_written == 0)
+            return false;
+
+        ptr += n_written;
+        n_bytes -= n_written;
+    }
+
+    return true;
+}
+
+FILE* open_ttable_file(const string& file_name)
+{
+    FILE* file = fopen(file_name.c_str(), "rb");
+    THROW_ASSERT(file != nullptr,
+                 "Failed to open ttable file \"" + file_name + "\"!");
+    return file;
+}
+
+} // namespace
+
+ttable_file_header make_ttable_file_header()
+{
+    ttable_file_header header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, TTABLE_FILE_MAGIC, sizeof(header.magic));
+    header.byte_order = TTABLE_FILE_BYTE_ORDER;
+    header.version = TTABLE_FILE_VERSION;
+
+    return header;
+}
+
+ttable_file_header read_ttable_file_header(const string& file_name)
+{
+    FILE* file = open_ttable_file(file_name);
+
+    ttable_file_header header;
+    const bool ok = read_all(file, &header, sizeof(header));
+    fclose(file);
+
+    const string error_prefix = "ttable file \"" + file_name + "\" ";
+
+    THROW_ASSERT(ok, error_prefix + "is too small!");
+
+    THROW_ASSERT(
+        memcmp(header.magic, TTABLE_FILE_MAGIC, sizeof(header.magic)) == 0,
+        error_prefix + "is not a ttable file!");
+
+    THROW_ASSERT(header.byte_order == TTABLE_FILE_BYTE_ORDER,
+                 error_prefix + "was written on a machine with different "
+                                "byte order!");
+
+    THROW_ASSERT(header.version == TTABLE_FILE_VERSION,
+                 error_prefix + "has unsupported version " +
+                     to_string(header.version) + "!");
+
+    return header;
+}
+
+void write_ttable_file(const string& file_name,
+                       const ttable_file_header& header, const void* data,
+                       size_t n_bytes)
+{
+    FILE* file = fopen(file_name.c_str(), "wb");
+    THROW_ASSERT(file != nullptr,
+                 "Failed to open ttable file \"" + file_name + "\"!");
+
+    const bool ok = write_all(file, &header, sizeof(header)) &&
+                    write_all(file, data, n_bytes);
+    const bool close_ok = fclose(file) == 0;
+
+    THROW_ASSERT(ok && close_ok,
+                 "Failed to write ttable file \"" + file_name + "\"!");
+}
+
+void read_ttable_file_data(const string& file_name, void* dst, size_t n_bytes)
+{
+    THROW_ASSERT(filesystem::file_size(file_name) ==
+                     sizeof(ttable_file_header) + n_bytes,
+                 "ttable file \"" + file_name + "\" has wrong size!");
+
+    FILE* file = open_ttable_file(file_name);
+
+    const bool ok = fseek(file, sizeof(ttable_file_header), SEEK_SET) == 0 &&
+                    read_all(file, dst, n_bytes);
+    fclose(file);
+
+    THROW_ASSERT(ok, "Failed to read ttable file \"" + file_name + "\"!");
+}
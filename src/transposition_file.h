@@ -0,0 +1,59 @@
+/*
+    File format for concurrent_ttable, laid out like the table in memory:
+
+        [ttable_file_header (64 bytes)][buckets (64 bytes each)]
+
+    so a table can be loaded by mapping the file (see mapped_file.h) instead
+    of reading and decoding it. Slots are written exactly as they are in
+    memory, so files can only be loaded on machines with the same byte order
+    (checked by read_ttable_file_header()).
+
+    See concurrent_ttable::save_file() and concurrent_ttable::load_file().
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Which table a file holds. Loading checks this matches
+enum ttable_file_kind
+{
+    TT_FILE_SUMGAME = 1,
+    TT_FILE_IMPARTIAL_MEX,
+    TT_FILE_LEMOINE_VIENNOT,
+};
+
+struct ttable_file_header
+{
+    char magic[8];
+    uint64_t byte_order; // TTABLE_FILE_BYTE_ORDER as written by this machine
+    uint64_t version;
+
+    uint64_t kind; // ttable_file_kind
+    uint64_t slot_bytes;
+    uint64_t entry_bytes;
+    uint64_t index_bits;
+    uint64_t bools_per_entry; // includes valid bit
+};
+
+// Keeps buckets cache line aligned in mapped files
+static_assert(sizeof(ttable_file_header) == 64);
+
+// Magic, byte order and version set; other fields 0
+ttable_file_header make_ttable_file_header();
+
+/*
+    Throws if the file can't be read, isn't a ttable file, or was written by
+    a different version or byte order
+*/
+ttable_file_header read_ttable_file_header(const std::string& file_name);
+
+// Writes header, then n_bytes of table data
+void write_ttable_file(const std::string& file_name,
+                       const ttable_file_header& header, const void* data,
+                       size_t n_bytes);
+
+// Reads the n_bytes following the header. Throws if the file size differs
+void read_ttable_file_data(const std::string& file_name, void* dst,
+                           size_t n_bytes);
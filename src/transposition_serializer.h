@@ -2,6 +2,7 @@
 
 #include "serializer.h"
 #include "transposition.h"
+#include "transposition_concurrent.h"
 
 template <class Entry>
 struct serializer<ttable<Entry>>
@@ -58,3 +59,62 @@ private:
     }
 };
 
+template <class Entry>
+struct serializer<concurrent_ttable<Entry>>
+{
+    using ttable_t = concurrent_ttable<Entry>;
+
+    static void save(i_obuffer& os, const ttable_t& tt, serializer_ctx* ctx)
+    {
+        os.write_u64(tt._n_index_bits);
+        os.write_u64(tt._bools_per_entry);
+
+        for (size_t i = 0; i < tt._n_buckets; i++)
+        {
+            for (const typename ttable_t::slot& s : tt._buckets[i].slots)
+            {
+                uint64_t data;
+                os.write_u64(ttable_t::_read_slot(s, data));
+
+                if constexpr (!ttable_t::_ENTRY_EMPTY)
+                    os.write_u64(data);
+            }
+        }
+    }
+
+    static ttable_t load(i_ibuffer& is, serializer_ctx* ctx)
+    {
+        ttable_t tt;
+        _load_impl(is, tt, ctx);
+        return tt;
+    }
+
+    static ttable_t* load_ptr(i_ibuffer& is, serializer_ctx* ctx)
+    {
+        ttable_t* tt = new ttable_t();
+        _load_impl(is, *tt, ctx);
+        return tt;
+    }
+
+private:
+    static void _load_impl(i_ibuffer& is, ttable_t& tt, serializer_ctx* ctx)
+    {
+        const size_t index_bits = is.read_u64();
+        const size_t bools_per_entry = is.read_u64();
+
+        THROW_ASSERT(bools_per_entry > 0);
+        tt._allocate(index_bits, bools_per_entry - 1);
+
+        for (size_t i = 0; i < tt._n_buckets; i++)
+        {
+            for (typename ttable_t::slot& s : tt._buckets[i].slots)
+            {
+                const uint64_t key = is.read_u64();
+                const uint64_t data =
+                    ttable_t::_ENTRY_EMPTY ? 0 : is.read_u64();
+
+                ttable_t::_write_slot(s, key, data);
+            }
+        }
+    }
+};
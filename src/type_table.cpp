@@ -5,6 +5,7 @@
 #include <cassert>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 
 bool type_table_t::_initialized = false;
 
@@ -18,6 +19,9 @@ namespace {
 std::unordered_map<std::type_index, std::shared_ptr<type_table_t>>
     type_table_map;
 
+// Games may be created by several search threads at once
+std::mutex type_table_mutex;
+
 } // namespace
 
 namespace __type_table_impl {
@@ -26,6 +30,8 @@ type_table_t* get_type_table(const std::type_info& tinfo)
 {
     const std::type_index tidx(tinfo);
 
+    std::lock_guard<std::mutex> lock(type_table_mutex);
+
     auto it = type_table_map.find(tidx);
 
     if (it == type_table_map.end())
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <atomic>
 
 using namespace std;
 
@@ -21,7 +22,8 @@ void warn_random_table_resize()
          << endl;
 }
 
-bool did_db_dom_moves_complexity_overflow;
+// Set by parallel DB generation workers
+atomic<bool> did_db_dom_moves_complexity_overflow;
 void warn_db_dom_moves_complexity_overflow()
 {
     if (global::silence_warnings())
@@ -50,10 +52,9 @@ void warn_on_exit::on_db_dom_moves_complexity_overflow()
 {
     assert(is_initialized);
 
-    if (did_db_dom_moves_complexity_overflow)
+    if (did_db_dom_moves_complexity_overflow.exchange(true))
         return;
 
-    did_db_dom_moves_complexity_overflow = true;
     warn_db_dom_moves_complexity_overflow();
 }
 
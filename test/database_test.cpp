@@ -1,6 +1,7 @@
 #include "database_test.h"
 
 #include <cstring>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <sstream>
@@ -663,6 +664,240 @@ void test_generate_options_size_score()
 
 }
 
+void test_generate_parallel()
+{
+    for (const db_gen_stop_after_enum stop_after : DB_GEN_STOP_AFTER_ENUM_ALL)
+    {
+        database db_serial;
+        database db_parallel;
+
+        for (database* db_ptr : {&db_serial, &db_parallel})
+        {
+            database& db = *db_ptr;
+            db.__register_built_in_types();
+            DATABASE_REGISTER_TYPE(db, clobber_1xn);
+            DATABASE_REGISTER_TYPE(db, domineering);
+
+            db_gen_options_t opts;
+            opts.silent = true;
+            opts.stop_after = stop_after;
+            opts.n_threads = (db_ptr == &db_serial) ? 1 : 4;
+
+            i_db_game_generator* gen = make_clobber_1xn_generator(6);
+            db.generate_entries_partisan(*gen, opts);
+            delete gen;
+
+            gen = make_domineering_generator(3, 3);
+            db.generate_entries_partisan(*gen, opts);
+            delete gen;
+        }
+
+        assert(db_serial.is_equal(db_parallel));
+    }
+}
+
+void test_indexed_file()
+{
+    const string file_name =
+        (filesystem::temp_directory_path() / "mcgs_indexed_db_test.bin")
+            .string();
+
+    const string stream_file_name =
+        (filesystem::temp_directory_path() / "mcgs_indexed_db_test_2.bin")
+            .string();
+
+    auto register_types = [](database& db) -> void
+    {
+        db.__register_built_in_types();
+        DATABASE_REGISTER_TYPE(db, clobber_1xn);
+        DATABASE_REGISTER_TYPE(db, domineering);
+    };
+
+    auto make_generators = []() -> vector<i_db_game_generator*>
+    {
+        return {make_clobber_1xn_generator(6),
+                make_domineering_generator(3, 3)};
+    };
+
+    database db;
+    register_types(db);
+
+    {
+        db_gen_options_t opts;
+        opts.silent = true;
+
+        for (i_db_game_generator* gen : make_generators())
+        {
+            db.generate_entries_partisan(*gen, opts);
+            delete gen;
+        }
+    }
+
+    db.save(file_name, DB_FILE_FORMAT_INDEXED);
+
+    database db_loaded;
+    db_loaded.load(file_name);
+    register_types(db_loaded);
+    assert(!db_loaded.empty());
+
+    // Entries are decoded one at a time
+    auto check_lookups = [&]() -> void
+    {
+        for (i_db_game_generator* gen : make_generators())
+        {
+            while (*gen)
+            {
+                game* g = gen->gen_game();
+
+                const db_entry_partisan* entry = db.get_partisan_ptr(*g);
+                const db_entry_partisan* entry_loaded =
+                    db_loaded.get_partisan_ptr(*g);
+
+                assert((entry == nullptr) == (entry_loaded == nullptr));
+                assert(entry == nullptr || *entry == *entry_loaded);
+
+                delete g;
+                ++(*gen);
+            }
+
+            delete gen;
+        }
+    };
+
+    check_lookups();
+
+    // Evict every segment, then decode them again
+    db_loaded.enforce_memory_budget(1);
+    assert(!db_loaded.empty());
+    check_lookups();
+
+    // No limit
+    db_loaded.enforce_memory_budget(0);
+    check_lookups();
+
+    // Not in the file
+    clobber_1xn clob("XOXOXOXOXO");
+    assert(db.get_partisan_ptr(clob) == nullptr);
+    assert(db_loaded.get_partisan_ptr(clob) == nullptr);
+
+    assert(db_loaded.is_equal(db));
+
+    // Indexed --> stream --> indexed
+    db_loaded.save(stream_file_name);
+
+    database db_stream;
+    db_stream.load(stream_file_name);
+    register_types(db_stream);
+    assert(db_stream.is_equal(db));
+
+    db_stream.save(file_name, DB_FILE_FORMAT_INDEXED);
+
+    database db_indexed;
+    db_indexed.load(file_name);
+    register_types(db_indexed);
+    assert(db_indexed.is_equal(db));
+
+    filesystem::remove(file_name);
+    filesystem::remove(stream_file_name);
+}
+
+void test_extend()
+{
+    const string file_name =
+        (filesystem::temp_directory_path() / "mcgs_extend_db_test.bin")
+            .string();
+
+    auto register_types = [](database& db) -> void
+    {
+        db.__register_built_in_types();
+        DATABASE_REGISTER_TYPE(db, clobber_1xn);
+    };
+
+    db_gen_options_t opts;
+    opts.silent = true;
+
+    auto generate = [&](database& db, int max_len) -> void
+    {
+        i_db_game_generator* gen = make_clobber_1xn_generator(max_len);
+        db.generate_entries_partisan(*gen, opts);
+        delete gen;
+    };
+
+    database db_small;
+    register_types(db_small);
+    generate(db_small, 5);
+    db_small.update_metadata_string("[clobber_1xn] max_dims = 5;");
+    db_small.save(file_name);
+
+    database db_extended;
+    db_extended.load(file_name);
+    register_types(db_extended);
+    db_extended.add_existing_entries_to_equivalence_classes(
+        game_type<clobber_1xn>());
+    generate(db_extended, 7);
+    db_extended.update_metadata_string("[clobber_1xn] max_dims = 7;");
+
+    database db_fresh;
+    register_types(db_fresh);
+    generate(db_fresh, 7);
+
+    db_extended.assert_links_equal(true);
+
+    // Existing entries and their links are unchanged
+    i_db_game_generator* gen = make_clobber_1xn_generator(5);
+    for (; *gen; ++(*gen))
+    {
+        unique_ptr<game> g(gen->gen_game());
+
+        const db_entry_partisan* entry_small = db_small.get_partisan_ptr(*g);
+        const db_entry_partisan* entry_extended =
+            db_extended.get_partisan_ptr(*g);
+
+        assert(entry_small == nullptr || entry_extended != nullptr);
+        assert(entry_small == nullptr || *entry_small == *entry_extended);
+    }
+    delete gen;
+
+    // Same entries as a fresh build, with equally simple linked entries
+    gen = make_clobber_1xn_generator(7);
+    for (; *gen; ++(*gen))
+    {
+        unique_ptr<game> g(gen->gen_game());
+
+        db_entry_partisan* entry_extended = db_extended.get_partisan_ptr(*g);
+        db_entry_partisan* entry_fresh = db_fresh.get_partisan_ptr(*g);
+
+        assert((entry_extended == nullptr) == (entry_fresh == nullptr));
+        if (entry_fresh == nullptr)
+            continue;
+
+        assert(entry_extended->outcome == entry_fresh->outcome);
+        assert(*entry_extended->thermograph == *entry_fresh->thermograph);
+        assert(*entry_extended->bounds_data == *entry_fresh->bounds_data);
+        assert(entry_extended->complexity == entry_fresh->complexity);
+        assert(entry_extended->size_score == entry_fresh->size_score);
+
+        const db_entry_partisan* linked_extended =
+            db_extended.get_partisan_ptr(entry_extended->simplest_equal_entry);
+        const db_entry_partisan* linked_fresh =
+            db_fresh.get_partisan_ptr(entry_fresh->simplest_equal_entry);
+
+        assert(linked_extended != nullptr && linked_fresh != nullptr);
+        assert(linked_extended->complexity == linked_fresh->complexity);
+        assert(linked_extended->size_score == linked_fresh->size_score);
+    }
+    delete gen;
+
+    // Metadata records both config strings
+    stringstream str;
+    str << db_extended;
+    assert(str.str().find("max_dims = 5;") != string::npos);
+    assert(str.str().find("Extended: ") != string::npos);
+    assert(str.str().find("max_dims = 7;") != string::npos);
+
+    filesystem::remove(file_name);
+}
+
 } // namespace
 
 void database_test_all(bool extra_tests)
@@ -673,4 +908,7 @@ void database_test_all(bool extra_tests)
     test_generate(extra_tests);
     test_generate_options_stop_after();
     test_generate_options_size_score();
+    test_generate_parallel();
+    test_indexed_file();
+    test_extend();
 }
@@ -7,8 +7,12 @@
 #include <vector>
 #include <cstddef>
 #include <cassert>
+#include <cstdint>
+#include <thread>
+#include <filesystem>
 
 #include "transposition.h"
+#include "transposition_concurrent.h"
 #include "clobber.h"
 #include "clobber_1xn.h"
 #include "test_utilities.h"
@@ -667,6 +671,400 @@ void test_compatibility()
 }
 
 } // namespace ttable_test
+
+namespace concurrent_ttable_test {
+
+typedef concurrent_ttable<ttable_test::test_entry> tt_test;
+
+void test_store_get()
+{
+    tt_test tt(4, 0);
+
+    ttable_test::test_entry ent = {41, 'D'};
+
+    hash_t hash = 13;
+
+    optional<ttable_test::test_entry> get1 = tt.get(hash);
+    assert(!get1.has_value());
+
+    tt.store(hash, ent);
+
+    optional<ttable_test::test_entry> get2 = tt.get(hash);
+    assert(get2.has_value());
+    assert(ent == get2.value());
+
+    for (hash_t i = 0; i < 4096; i++)
+    {
+        optional<ttable_test::test_entry> get3 = tt.get(i);
+        if (i == hash)
+            assert(get3.has_value());
+        else
+            assert(!get3.has_value());
+    }
+
+    tt.clear();
+    assert(!tt.get(hash).has_value());
+}
+
+void test_exceptions()
+{
+    tt_test tt(4, 1);
+
+    tt_test::search_result sr = tt.search(6);
+    assert(!sr.entry_valid());
+
+    ASSERT_DID_THROW({
+        const ttable_test::test_entry& ent = sr.get_entry();
+        (void) ent; // avoid unused variable warning
+    });
+
+    ASSERT_DID_THROW(sr.get_bool(0));
+    ASSERT_DID_THROW(sr.set_bool(0, true));
+
+    sr.set_entry({30, 'R'});
+    assert(sr.entry_valid());
+    assert(sr.get_bool(0) == false);
+
+    ASSERT_DID_THROW(sr.get_bool(1));
+    ASSERT_DID_THROW(sr.set_bool(1, true));
+
+    ASSERT_DID_THROW({
+        tt_test tt_zero(4, 1);
+        tt_zero.store(0, {}); // can't use store() if there are bools
+    });
+
+    // bools are stored in the bucket index bits
+    ASSERT_DID_THROW(tt_test(2, 2));
+    ASSERT_DID_THROW(tt_test(4, 2));
+
+    // less than one bucket
+    ASSERT_DID_THROW(tt_test(1, 0));
+}
+
+void test_search_result()
+{
+    tt_test tt(6, 2);
+
+    ttable_test::test_entry entry = {61, 'C'};
+    hash_t hash = 0xABC0;
+
+    {
+        tt_test::search_result sr = tt.search(hash);
+        assert(!sr.entry_valid());
+
+        sr.init_entry(entry);
+        sr.set_bool(1, true);
+        assert(sr.get_entry() == entry);
+        assert(sr.get_bool(0) == false);
+        assert(sr.get_bool(1) == true);
+
+        // Not written until sr is destroyed
+        assert(!tt.get(hash).has_value());
+    }
+
+    assert(tt.get(hash).has_value());
+    assert(tt.get(hash).value() == entry);
+
+    {
+        tt_test::search_result sr = tt.search(hash);
+        assert(sr.entry_valid());
+        assert(sr.get_entry() == entry);
+        assert(sr.get_bool(0) == false);
+        assert(sr.get_bool(1) == true);
+
+        // Bools are kept by set_entry(), and reset by init_entry()
+        entry.val1++;
+        sr.set_entry(entry);
+        assert(sr.get_bool(1) == true);
+
+        sr.init_entry();
+        assert(sr.get_entry() == ttable_test::test_entry());
+        assert(sr.get_bool(1) == false);
+        sr.set_bool(0, true);
+
+        // Moved-from search_result doesn't write
+        tt_test::search_result sr_moved(std::move(sr));
+        sr_moved.set_entry(entry);
+    }
+
+    {
+        tt_test::search_result sr = tt.search(hash);
+        assert(sr.entry_valid());
+        assert(sr.get_entry() == entry);
+        assert(sr.get_bool(0) == true);
+        assert(sr.get_bool(1) == false);
+    }
+
+    // Hashes sharing a bucket don't replace each other until it's full
+    const hash_t hash_colliding = hash + 16;
+
+    {
+        tt_test::search_result sr = tt.search(hash_colliding);
+        assert(!sr.entry_valid());
+        sr.init_entry();
+    }
+
+    assert(tt.search(hash).entry_valid());
+    assert(tt.search(hash_colliding).entry_valid());
+    assert(tt.search(hash_colliding).get_bool(0) == false);
+}
+
+void test_buckets()
+{
+    // 4 slots per bucket for 8 byte entries, so 2 buckets
+    tt_test tt(3, 0);
+
+    auto make_entry = [](hash_t hash) -> ttable_test::test_entry
+    {
+        return {static_cast<int>(hash), 'B'};
+    };
+
+    // Fill bucket 0
+    for (hash_t i = 0; i < 4; i++)
+        tt.store(i * 2, make_entry(i * 2));
+
+    for (hash_t i = 0; i < 4; i++)
+    {
+        optional<ttable_test::test_entry> ent = tt.get(i * 2);
+        assert(ent.has_value() && ent.value() == make_entry(i * 2));
+    }
+
+    // Bucket 1 is unaffected
+    for (hash_t i = 0; i < 4; i++)
+        assert(!tt.get(i * 2 + 1).has_value());
+
+    // Overwriting an entry doesn't use another slot
+    tt.store(4, make_entry(100));
+    assert(tt.get(4).value() == make_entry(100));
+
+    for (hash_t i = 0; i < 4; i++)
+        assert(tt.get(i * 2).has_value());
+
+    // Full bucket: one entry is replaced
+    tt.store(8, make_entry(8));
+    assert(tt.get(8).value() == make_entry(8));
+
+    size_t n_valid = 0;
+    for (hash_t i = 0; i < 4; i++)
+        n_valid += tt.get(i * 2).has_value();
+
+    assert(n_valid == 3);
+}
+
+void store_with_effort(tt_test& tt, hash_t hash, uint64_t depth,
+                       uint64_t subtree_size)
+{
+    tt_test::search_result sr = tt.search(hash);
+    sr.init_entry({static_cast<int>(hash >> 10), 'P'});
+    sr.set_effort(depth, subtree_size);
+}
+
+void test_replace_depth()
+{
+    // 4 slots per bucket. Hashes i << 10 are all in bucket 0
+    tt_test tt(12, 0, TT_REPLACE_DEPTH);
+    assert(tt.get_replacement_policy() == TT_REPLACE_DEPTH);
+
+    for (hash_t i = 1; i <= 4; i++)
+        store_with_effort(tt, i << 10, i, 1);
+
+    // Deeper than everything in the bucket
+    store_with_effort(tt, 5 << 10, 10, 1);
+    assert(!tt.get(5 << 10).has_value());
+
+    for (hash_t i = 1; i <= 4; i++)
+        assert(tt.get(i << 10).has_value());
+
+    // Evicts the deepest entry
+    store_with_effort(tt, 6 << 10, 0, 1);
+    assert(tt.get(6 << 10).has_value());
+    assert(!tt.get(4 << 10).has_value());
+
+    for (hash_t i = 1; i <= 3; i++)
+        assert(tt.get(i << 10).has_value());
+
+    // Same hash is always overwritten, even if deeper
+    store_with_effort(tt, 1 << 10, 20, 1);
+
+    const ttable_store_counts counts = tt.get_store_counts();
+    assert(counts.inserts == 4);
+    assert(counts.overwrites == 1);
+    assert(counts.evictions == 1);
+    assert(counts.rejections == 1);
+}
+
+void test_replace_subtree_size()
+{
+    tt_test tt(12, 0, TT_REPLACE_SUBTREE_SIZE);
+
+    for (hash_t i = 1; i <= 4; i++)
+        store_with_effort(tt, i << 10, 0, 8 << i);
+
+    // Smaller subtree than everything in the bucket
+    store_with_effort(tt, 5 << 10, 0, 2);
+    assert(!tt.get(5 << 10).has_value());
+
+    // Evicts the smallest subtree
+    store_with_effort(tt, 6 << 10, 0, 1000);
+    assert(tt.get(6 << 10).has_value());
+    assert(!tt.get(1 << 10).has_value());
+
+    for (hash_t i = 2; i <= 4; i++)
+        assert(tt.get(i << 10).has_value());
+
+    const ttable_store_counts counts = tt.get_store_counts();
+    assert(counts.inserts == 4);
+    assert(counts.evictions == 1);
+    assert(counts.rejections == 1);
+}
+
+void test_replace_two_tier()
+{
+    // Slots 0 and 1 are kept by subtree size, 2 and 3 always replaced
+    tt_test tt(12, 0, TT_REPLACE_TWO_TIER);
+
+    store_with_effort(tt, 1 << 10, 0, 1024);
+    store_with_effort(tt, 2 << 10, 0, 512);
+    store_with_effort(tt, 3 << 10, 0, 2);
+    store_with_effort(tt, 4 << 10, 0, 2);
+
+    // Larger than 2's subtree: 2 is demoted to the second tier (slot 3,
+    // chosen by hash 5), where it replaces 4
+    store_with_effort(tt, 5 << 10, 0, 4096);
+
+    assert(tt.get(5 << 10).has_value());
+    assert(tt.get(1 << 10).has_value());
+    assert(tt.get(2 << 10).has_value());
+    assert(tt.get(3 << 10).has_value());
+    assert(!tt.get(4 << 10).has_value());
+
+    // Small subtree goes straight to the second tier (slot 2), replacing 3
+    store_with_effort(tt, 6 << 10, 0, 1);
+
+    assert(tt.get(6 << 10).has_value());
+    assert(tt.get(1 << 10).has_value());
+    assert(tt.get(2 << 10).has_value());
+    assert(tt.get(5 << 10).has_value());
+    assert(!tt.get(3 << 10).has_value());
+
+    const ttable_store_counts counts = tt.get_store_counts();
+    assert(counts.inserts == 4);
+    assert(counts.evictions == 2);
+    assert(counts.rejections == 0);
+}
+
+void test_replacement_policy_strings()
+{
+    for (ttable_replacement_policy policy :
+         {TT_REPLACE_ALWAYS, TT_REPLACE_DEPTH, TT_REPLACE_SUBTREE_SIZE,
+          TT_REPLACE_TWO_TIER})
+    {
+        const string name = ttable_replacement_policy_to_string(policy);
+        optional<ttable_replacement_policy> parsed =
+            ttable_replacement_policy_from_string(name);
+
+        assert(parsed.has_value() && parsed.value() == policy);
+    }
+
+    assert(!ttable_replacement_policy_from_string("sometimes").has_value());
+}
+
+void test_file()
+{
+    const string file_name =
+        (filesystem::temp_directory_path() / "mcgs_concurrent_ttable_test.bin")
+            .string();
+
+    tt_test tt(8, 1);
+
+    for (hash_t i = 0; i < 200; i++)
+    {
+        const hash_t hash = i * 0x9E3779B97F4A7C15ull;
+        tt_test::search_result sr = tt.search(hash);
+        sr.init_entry({static_cast<int>(i), 'F'});
+        sr.set_bool(0, i % 3 == 0);
+    }
+
+    tt.save_file(file_name, TT_FILE_SUMGAME);
+
+    for (bool use_mmap : {false, true})
+    {
+        tt_test tt_loaded =
+            tt_test::load_file(file_name, TT_FILE_SUMGAME, use_mmap);
+
+        assert(tt_loaded.is_mapped() == (use_mmap && mapped_file::SUPPORTED));
+        assert(tt_loaded == tt);
+
+        // Changes to a mapped table stay in this process
+        tt_loaded.clear();
+        assert(tt_loaded != tt);
+    }
+
+    assert(tt_test::load_file(file_name, TT_FILE_SUMGAME, true) == tt);
+
+    // Different table kind, or entry size
+    ASSERT_DID_THROW(tt_test::load_file(file_name, TT_FILE_IMPARTIAL_MEX,
+                                        false));
+    ASSERT_DID_THROW(concurrent_ttable<int>::load_file(
+        file_name, TT_FILE_SUMGAME, false));
+
+    filesystem::remove(file_name);
+}
+
+void test_parallel()
+{
+    /*
+        Many threads store and read a small table. Entries are derived from
+        their hashes, so any hit with a different entry means a torn slot was
+        accepted.
+    */
+    tt_test tt(6, 1);
+
+    auto make_entry = [](hash_t hash) -> ttable_test::test_entry
+    {
+        return {static_cast<int>(hash >> 32), static_cast<char>(hash >> 8)};
+    };
+
+    const size_t N_THREADS = 4;
+    const size_t N_ITERATIONS = 20000;
+
+    vector<thread> threads;
+    for (size_t t = 0; t < N_THREADS; t++)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                hash_t hash = 0x9E3779B97F4A7C15ull * (t + 1);
+
+                for (size_t i = 0; i < N_ITERATIONS; i++)
+                {
+                    hash = hash * 6364136223846793005ull +
+                           1442695040888963407ull;
+
+                    // Small key space so threads collide on entries
+                    const hash_t key = hash & 0xFFFF00000000FF3Full;
+
+                    tt_test::search_result sr = tt.search(key);
+
+                    if (sr.entry_valid())
+                    {
+                        assert(sr.get_entry() == make_entry(key));
+                        assert(sr.get_bool(0) == ((key >> 40) & 1));
+                    }
+                    else
+                    {
+                        sr.init_entry(make_entry(key));
+                        sr.set_bool(0, (key >> 40) & 1);
+                    }
+                }
+            });
+    }
+
+    for (thread& th : threads)
+        th.join();
+}
+
+} // namespace concurrent_ttable_test
 } // namespace
 
 void hash_types_test_all()
@@ -690,4 +1088,15 @@ void hash_types_test_all()
     ttable_test::test_search_result();
     ttable_test::test_colliding_search_results();
     ttable_test::test_compatibility();
+
+    concurrent_ttable_test::test_store_get();
+    concurrent_ttable_test::test_exceptions();
+    concurrent_ttable_test::test_search_result();
+    concurrent_ttable_test::test_buckets();
+    concurrent_ttable_test::test_replace_depth();
+    concurrent_ttable_test::test_replace_subtree_size();
+    concurrent_ttable_test::test_replace_two_tier();
+    concurrent_ttable_test::test_replacement_policy_strings();
+    concurrent_ttable_test::test_file();
+    concurrent_ttable_test::test_parallel();
 }
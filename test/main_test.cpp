@@ -87,6 +87,7 @@ static stopwatch sw;
 #include "sumgame_helpers_test.h"
 #include "sumgame_map_view_test.h"
 #include "sumgame_test.h"
+#include "test_work_queue_test.h"
 #include "thermograph_helpers_test.h"
 #include "throw_assert.h"
 #include "toppling_dominoes_test.h"
@@ -175,6 +176,7 @@ int main(int argc, const char** argv)
     RUN_TEST(safe_arithmetic_test_all());
 
     RUN_TEST(bit_array_test_all());
+    RUN_TEST(test_work_queue_test_all());
 
     // CGT utility functions
     RUN_TEST(cgt_basics_test_all());
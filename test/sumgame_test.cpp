@@ -12,6 +12,11 @@
 #include "sumgame_test_up_star.h"
 #include "sumgame_test_switch.h"
 #include "sumgame_test_mixed.h"
+#include "sumgame_test_dfpn.h"
+#include "sumgame_test_move_ordering.h"
+#include "sumgame_test_ttable_move.h"
+#include "sumgame_test_iterative_deepening.h"
+#include "sumgame_test_parallel.h"
 
 void sumgame_test_all()
 {
@@ -27,4 +32,9 @@ void sumgame_test_all()
     sumgame_test_up_star_all();
     sumgame_test_switch_all();
     sumgame_test_mixed_all();
+    sumgame_test_parallel_all();
+    sumgame_test_dfpn_all();
+    sumgame_test_move_ordering_all();
+    sumgame_test_ttable_move_all();
+    sumgame_test_iterative_deepening_all();
 }
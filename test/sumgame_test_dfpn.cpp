@@ -0,0 +1,101 @@
+#include "sumgame_test_dfpn.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "clobber.h"
+#include "clobber_1xn.h"
+#include "global_options.h"
+#include "nogo_1xn.h"
+#include "sumgame.h"
+#include "test_utilities.h"
+
+using namespace std;
+
+namespace {
+
+// Compare minimax search with df-pn search, for both players
+void assert_dfpn_matches_minimax(const vector<game*>& games)
+{
+    assert(global::search_algorithm() == "minimax");
+
+    for (bw player : {BLACK, WHITE})
+    {
+        sumgame sum(player);
+        sum.add(games);
+
+        sumgame::clear_ttable();
+        const bool minimax_win = sum.solve();
+
+        global::search_algorithm.set("dfpn");
+        sumgame::clear_ttable();
+        const bool dfpn_win = sum.solve();
+        global::search_algorithm.set("minimax");
+
+        assert(minimax_win == dfpn_win);
+        sum.pop(games);
+    }
+
+    for (game* g : games)
+        delete g;
+}
+
+void test_known_outcomes()
+{
+    global::search_algorithm.set("dfpn");
+
+    assert_sum_outcomes(false, true,
+                        {
+                            new clobber("OX|XO|OX|OX"),
+                            new clobber("XO|OO"),
+                        });
+
+    assert_sum_outcomes(true, false,
+                        {
+                            new clobber("XXO|...|XO."),
+                            new clobber("X|O"),
+                        });
+
+    // No moves at the root
+    assert_sum_outcomes(false, false, {new clobber("XX|..")});
+
+    global::search_algorithm.set("minimax");
+}
+
+void test_matches_minimax()
+{
+    assert_dfpn_matches_minimax({
+        new clobber("XOX|OXO|X.O"),
+        new clobber_1xn("XOXOXO"),
+    });
+
+    assert_dfpn_matches_minimax({
+        new clobber("XO.|OXO"),
+        new nogo_1xn("X....O.."),
+        new clobber_1xn("OXXO"),
+    });
+
+    assert_dfpn_matches_minimax({
+        new clobber_1xn("XOXXOOXO.OX"),
+        new nogo_1xn(".X..O..."),
+    });
+}
+
+} // namespace
+
+void sumgame_test_dfpn_all()
+{
+    const bool clear_tt = global::clear_tt();
+    const string search_algorithm = global::search_algorithm();
+
+    global::clear_tt.set(true);
+    global::search_algorithm.set("minimax");
+
+    test_known_outcomes();
+    test_matches_minimax();
+
+    global::search_algorithm.set(search_algorithm);
+    global::clear_tt.set(clear_tt);
+}
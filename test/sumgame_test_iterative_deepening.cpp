@@ -0,0 +1,137 @@
+#include "sumgame_test_iterative_deepening.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "clobber.h"
+#include "clobber_1xn.h"
+#include "nogo_1xn.h"
+#include "sumgame.h"
+#include "sumgame_iterative_deepening.h"
+#include "timeout_token.h"
+
+using namespace std;
+
+namespace {
+
+bool move_wins(sumgame& sum, const sumgame_move& sm, bw player)
+{
+    sum.play_sum(sm, player);
+    const bool win = !sum.solve();
+    sum.undo_move();
+
+    return win;
+}
+
+/*
+    Compare iterative deepening with minimax search, for both players, and
+    check the proven root moves
+*/
+void assert_matches_minimax(const vector<game*>& games)
+{
+    for (bw player : {BLACK, WHITE})
+    {
+        sumgame sum(player);
+        sum.add(games);
+
+        const iterative_deepening_result result =
+            solve_iterative_deepening(sum, 0);
+
+        assert(result.win.has_value());
+        assert(*result.win == sum.solve());
+        assert(result.winning_move.has_value() == *result.win);
+
+        if (*result.win)
+            assert(move_wins(sum, *result.winning_move, player));
+        else
+            assert(result.unresolved_moves.empty());
+
+        for (const sumgame_move& sm : result.losing_moves)
+            assert(!move_wins(sum, sm, player));
+
+        assert(sum.to_play() == player);
+        sum.pop(games);
+    }
+
+    for (game* g : games)
+        delete g;
+}
+
+void test_matches_minimax()
+{
+    assert_matches_minimax({
+        new clobber("XOX|OXO|X.O"),
+        new clobber_1xn("XOXOXO"),
+    });
+
+    assert_matches_minimax({
+        new clobber("XO.|OXO"),
+        new nogo_1xn("X....O.."),
+        new clobber_1xn("OXXO"),
+    });
+
+    assert_matches_minimax({new clobber_1xn("XOXOXOXO.XO")});
+}
+
+void test_no_moves()
+{
+    clobber g("XX|..");
+
+    sumgame sum(BLACK);
+    sum.add(&g);
+
+    const iterative_deepening_result result =
+        solve_iterative_deepening(sum, 0);
+
+    assert(result.win.has_value() && !*result.win);
+    assert(!result.winning_move.has_value());
+    assert(result.losing_moves.empty() && result.unresolved_moves.empty());
+    assert(result.completed_depth == 0);
+
+    sum.pop(&g);
+}
+
+// Timeout before the first iteration: every root move is unresolved
+void test_timeout()
+{
+    clobber_1xn g("XOXOXO");
+
+    sumgame sum(BLACK);
+    sum.add(&g);
+
+    atomic<bool> should_stop(true);
+    const timeout_token tok(&should_stop);
+
+    const iterative_deepening_result result =
+        solve_iterative_deepening_with_token(sum, tok);
+
+    assert(!result.win.has_value());
+    assert(result.losing_moves.empty());
+
+    size_t n_moves = 0;
+    {
+        unique_ptr<sumgame_move_generator> gen(
+            sum.create_sum_move_generator(BLACK));
+
+        for (; *gen; ++(*gen))
+            n_moves++;
+    }
+
+    assert(n_moves > 0 && result.unresolved_moves.size() == n_moves);
+    assert(result.completed_depth == 0);
+
+    sum.pop(&g);
+}
+
+} // namespace
+
+void sumgame_test_iterative_deepening_all()
+{
+    test_matches_minimax();
+    test_no_moves();
+    test_timeout();
+}
@@ -0,0 +1,142 @@
+#include "sumgame_test_move_ordering.h"
+
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "clobber.h"
+#include "clobber_1xn.h"
+#include "global_options.h"
+#include "nogo_1xn.h"
+#include "sumgame.h"
+#include "sumgame_move_ordering.h"
+
+using namespace std;
+
+namespace {
+
+void test_strings()
+{
+    assert(move_ordering_from_string("none") == MOVE_ORDERING_NONE);
+    assert(move_ordering_from_string("all") == MOVE_ORDERING_ALL);
+    assert(move_ordering_from_string("db,tt") ==
+           (MOVE_ORDERING_TT | MOVE_ORDERING_DB));
+    assert(move_ordering_from_string("killer") == MOVE_ORDERING_KILLER);
+
+    assert(!move_ordering_from_string("").has_value());
+    assert(!move_ordering_from_string("tt,,db").has_value());
+    assert(!move_ordering_from_string("history").has_value());
+
+    assert(move_ordering_to_string(MOVE_ORDERING_NONE) == "none");
+    assert(move_ordering_to_string(MOVE_ORDERING_TT | MOVE_ORDERING_DB) ==
+           "tt,db");
+    assert(move_ordering_to_string(MOVE_ORDERING_ALL) == "tt,killer,db");
+
+    for (move_ordering_t ordering = 0; ordering <= MOVE_ORDERING_ALL;
+         ordering++)
+        assert(move_ordering_from_string(move_ordering_to_string(ordering)) ==
+               ordering);
+}
+
+void test_killers()
+{
+    clobber_1xn g("XOXO.XO");
+
+    sumgame sum(BLACK);
+    sum.add(&g);
+
+    vector<sumgame_move> generated;
+    {
+        unique_ptr<sumgame_move_generator> mg(
+            sum.create_sum_move_generator(BLACK));
+
+        for (; *mg; ++(*mg))
+            generated.push_back(mg->gen_sum_move());
+    }
+
+    assert(generated.size() >= 3);
+
+    sumgame_move_orderer orderer(MOVE_ORDERING_KILLER);
+
+    // Most recent killer first
+    orderer.add_killer(sum, generated[2], 5);
+    orderer.add_killer(sum, generated[1], 5);
+
+    vector<sumgame_move> moves = generated;
+    orderer.order_moves(sum, BLACK, 5, moves);
+
+    assert(moves.size() == generated.size());
+    assert(moves[0] == generated[1]);
+    assert(moves[1] == generated[2]);
+    assert(moves[2] == generated[0]);
+
+    // No killers at other depths
+    moves = generated;
+    orderer.order_moves(sum, BLACK, 4, moves);
+    assert(moves == generated);
+
+    sum.pop(&g);
+}
+
+// Compare each ordering with generator order, for both players
+void assert_orderings_match(const vector<game*>& games)
+{
+    assert(global::move_ordering() == "none");
+
+    for (bw player : {BLACK, WHITE})
+    {
+        sumgame sum(player);
+        sum.add(games);
+
+        // Small empty ttables are faster than clearing the global one
+        const bool expected = sum.solve_with_ttable(
+            make_shared<ttable_sumgame>(16, TTABLE_SUMGAME_N_BOOLS));
+
+        for (const char* ordering : {"tt", "killer", "db", "all"})
+        {
+            global::move_ordering.set(ordering);
+            assert(sum.solve_with_ttable(make_shared<ttable_sumgame>(
+                       16, TTABLE_SUMGAME_N_BOOLS)) == expected);
+        }
+
+        global::move_ordering.set("none");
+        sum.pop(games);
+    }
+
+    for (game* g : games)
+        delete g;
+}
+
+void test_matches_unordered()
+{
+    assert_orderings_match({
+        new clobber("XOX|OXO|X.O"),
+        new clobber_1xn("XOXOXO"),
+    });
+
+    assert_orderings_match({
+        new clobber("XO.|OXO"),
+        new nogo_1xn("X....O.."),
+        new clobber_1xn("OXXO"),
+    });
+
+    // No moves at the root
+    assert_orderings_match({new clobber("XX|..")});
+}
+
+} // namespace
+
+void sumgame_test_move_ordering_all()
+{
+    const string move_ordering = global::move_ordering();
+    global::move_ordering.set("none");
+
+    test_strings();
+    test_killers();
+    test_matches_unordered();
+
+    global::move_ordering.set(move_ordering);
+}
@@ -0,0 +1,2 @@
+#pragma once
+void sumgame_test_move_ordering_all();
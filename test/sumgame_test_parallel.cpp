@@ -0,0 +1,100 @@
+#include "sumgame_test_parallel.h"
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "clobber.h"
+#include "clobber_1xn.h"
+#include "global_options.h"
+#include "nogo_1xn.h"
+#include "sumgame.h"
+#include "test_utilities.h"
+
+using namespace std;
+
+namespace {
+
+// Compare serial search with root split search, for both players
+void assert_parallel_matches_serial(const vector<game*>& games,
+                                    size_t n_threads)
+{
+    assert(global::threads() == 1);
+
+    for (bw player : {BLACK, WHITE})
+    {
+        sumgame sum(player);
+        sum.add(games);
+
+        sumgame::clear_ttable();
+        const bool serial_win = sum.solve();
+
+        global::threads.set(n_threads);
+        sumgame::clear_ttable();
+        const bool parallel_win = sum.solve();
+        global::threads.set(1);
+
+        assert(serial_win == parallel_win);
+        sum.pop(games);
+    }
+
+    for (game* g : games)
+        delete g;
+}
+
+void test_known_outcomes()
+{
+    global::threads.set(4);
+
+    assert_sum_outcomes(false, true,
+                        {
+                            new clobber("OX|XO|OX|OX"),
+                            new clobber("XO|OO"),
+                        });
+
+    assert_sum_outcomes(true, false,
+                        {
+                            new clobber("XXO|...|XO."),
+                            new clobber("X|O"),
+                        });
+
+    // No moves at the root
+    assert_sum_outcomes(false, false, {new clobber("XX|..")});
+
+    global::threads.set(1);
+}
+
+void test_matches_serial()
+{
+    assert_parallel_matches_serial(
+        {
+            new clobber("XOX|OXO|X.O"),
+            new clobber_1xn("XOXOXO"),
+        },
+        2);
+
+    assert_parallel_matches_serial(
+        {
+            new clobber("XO.|OXO"),
+            new nogo_1xn("X....O.."),
+            new clobber_1xn("OXXO"),
+        },
+        3);
+
+    // More threads than root moves
+    assert_parallel_matches_serial({new clobber_1xn("XO")}, 8);
+}
+
+} // namespace
+
+void sumgame_test_parallel_all()
+{
+    const bool clear_tt = global::clear_tt();
+    global::clear_tt.set(true);
+
+    test_known_outcomes();
+    test_matches_serial();
+
+    global::clear_tt.set(clear_tt);
+}
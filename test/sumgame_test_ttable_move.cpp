@@ -0,0 +1,105 @@
+#include "sumgame_test_ttable_move.h"
+
+#include <cassert>
+#include <optional>
+#include <vector>
+
+#include "cgt_basics.h"
+#include "clobber.h"
+#include "clobber_1xn.h"
+#include "nogo_1xn.h"
+#include "sumgame.h"
+
+using namespace std;
+
+namespace {
+
+/*
+    For both players: a winning sum's stored move must win, and a losing
+    sum has no stored move
+*/
+void assert_ttable_moves_win(const vector<game*>& games)
+{
+    for (bw player : {BLACK, WHITE})
+    {
+        sumgame sum(player);
+        sum.add(games);
+
+        optional<sumgame_move> winning_move;
+        const optional<solve_result> result =
+            sum.solve_with_timeout(0, &winning_move);
+
+        assert(result.has_value());
+
+        if (!result->win)
+            assert(!winning_move.has_value());
+        else if (winning_move.has_value())
+        {
+            sum.play_sum(*winning_move, player);
+            assert(!sum.solve());
+            sum.undo_move();
+        }
+
+        // Also from a ttable which already has the sum
+        const mcgs_player_move pm = sum.get_winning_or_random_move(player);
+        assert(pm.status == MCGS_PLAYER_MOVE_STATUS_OK);
+        assert(pm.sm.has_value());
+
+        if (result->win)
+        {
+            sum.play_sum(*pm.sm, player);
+            assert(!sum.solve());
+            sum.undo_move();
+        }
+
+        assert(sum.to_play() == player);
+        sum.pop(games);
+    }
+
+    for (game* g : games)
+        delete g;
+}
+
+void test_moves_win()
+{
+    assert_ttable_moves_win({new clobber("XOX|OXO|X.O")});
+
+    assert_ttable_moves_win({
+        new clobber("XOX|OXO|X.O"),
+        new clobber_1xn("XOXOXO"),
+    });
+
+    assert_ttable_moves_win({
+        new clobber("XO.|OXO"),
+        new nogo_1xn("X....O.."),
+        new clobber_1xn("OXXO"),
+    });
+}
+
+void test_no_moves()
+{
+    clobber g("XX|..");
+
+    sumgame sum(BLACK);
+    sum.add(&g);
+
+    optional<sumgame_move> winning_move;
+    const optional<solve_result> result =
+        sum.solve_with_timeout(0, &winning_move);
+
+    assert(result.has_value() && !result->win);
+    assert(!winning_move.has_value());
+
+    assert(sum.get_winning_or_random_move(BLACK).status ==
+           MCGS_PLAYER_MOVE_STATUS_NO_MOVES);
+
+    sum.pop(&g);
+}
+
+} // namespace
+
+void sumgame_test_ttable_move_all()
+{
+    test_moves_win();
+    test_no_moves();
+}
@@ -0,0 +1,129 @@
+#include "test_work_queue_test.h"
+#include "test_work_queue.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Pop from worker until empty
+vector<size_t> pop_all(test_work_queue& queue, size_t worker_idx)
+{
+    vector<size_t> positions;
+
+    while (optional<size_t> pos = queue.pop(worker_idx))
+        positions.push_back(*pos);
+
+    return positions;
+}
+
+void test_schedule()
+{
+    {
+        // Hardest first in each range, dealt round-robin
+        const vector<uint64_t> difficulties {5, 9, 1, 7, 3};
+        const vector<size_t> schedule = make_test_schedule(difficulties, 2);
+
+        // Order: 1 (9), 3 (7), 0 (5), 4 (3), 2 (1). Ranges of sizes 3 and 2
+        const vector<size_t> expected {1, 0, 2, 3, 4};
+        assert(schedule == expected);
+    }
+
+    {
+        // Ties keep their order
+        const vector<uint64_t> difficulties {2, 2, 2, 2};
+        const vector<size_t> schedule = make_test_schedule(difficulties, 1);
+
+        const vector<size_t> expected {0, 1, 2, 3};
+        assert(schedule == expected);
+    }
+
+    {
+        const vector<uint64_t> difficulties;
+        assert(make_test_schedule(difficulties, 4).empty());
+    }
+}
+
+void test_pop_and_steal()
+{
+    test_work_queue::range_t ranges[3];
+    test_work_queue queue(ranges, 3, 7);
+
+    assert(test_work_queue::initial_range_size(0, 3, 7) == 3);
+    assert(test_work_queue::initial_range_size(1, 3, 7) == 2);
+    assert(test_work_queue::initial_range_size(2, 3, 7) == 2);
+
+    // Ranges: [0, 3), [3, 5), [5, 7)
+    assert(queue.pop(1) == 3);
+    assert(queue.pop(1) == 4);
+
+    // Worker 1 steals the back half of worker 0's range
+    assert(queue.pop(1) == 1);
+    assert(queue.pop(1) == 2);
+    assert(queue.pop(0) == 0);
+
+    // Worker 0 steals 6 from [5, 7), then worker 2 takes 5
+    assert(queue.pop(0) == 6);
+    assert(queue.pop(2) == 5);
+
+    assert(!queue.pop(0).has_value());
+    assert(!queue.pop(1).has_value());
+    assert(!queue.pop(2).has_value());
+}
+
+void test_no_items()
+{
+    test_work_queue::range_t ranges[2];
+    test_work_queue queue(ranges, 2, 0);
+
+    assert(!queue.pop(0).has_value());
+    assert(!queue.pop(1).has_value());
+}
+
+void test_threads()
+{
+    const size_t n_workers = 4;
+    const size_t n_items = 10000;
+
+    test_work_queue::range_t ranges[n_workers];
+    test_work_queue queue(ranges, n_workers, n_items);
+
+    vector<vector<size_t>> popped(n_workers);
+    vector<thread> threads;
+
+    for (size_t i = 0; i < n_workers; i++)
+        threads.emplace_back([&, i]() { popped[i] = pop_all(queue, i); });
+
+    for (thread& t : threads)
+        t.join();
+
+    // Each position is taken exactly once
+    vector<int> counts(n_items, 0);
+
+    for (const vector<size_t>& positions : popped)
+        for (size_t pos : positions)
+        {
+            assert(pos < n_items);
+            counts[pos]++;
+        }
+
+    for (int count : counts)
+        assert(count == 1);
+}
+
+} // namespace
+
+void test_work_queue_test_all()
+{
+    test_schedule();
+    test_pop_and_steal();
+    test_no_items();
+    test_threads();
+}
@@ -0,0 +1,2 @@
+#pragma once
+void test_work_queue_test_all();